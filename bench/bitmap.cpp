@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <bitmap.hpp>
+#include <png.hpp>
+
+using namespace rt;
+
+namespace {
+
+// Gradients compress about as well as a render does, a flat image would flatter the encoder
+bitmap make_gradient(std::size_t size) {
+    bitmap b{size, size};
+    for (std::size_t y = 0; y < size; y++) {
+        for (std::size_t x = 0; x < size; x++) {
+            b.set_pixel({static_cast<float>(x) / static_cast<float>(size), static_cast<float>(y) / static_cast<float>(size), 0.5f}, x, y);
+        }
+    }
+    return b;
+}
+
+} // namespace
+
+static void bitmap_get_raw_png(benchmark::State& state) {
+    const auto b = make_gradient(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(b.get_raw_png());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * state.range(0) * 3);
+}
+BENCHMARK(bitmap_get_raw_png)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void bitmap_save(benchmark::State& state) {
+    const auto b = make_gradient(static_cast<std::size_t>(state.range(0)));
+    const auto path = (std::filesystem::temp_directory_path() / "raytracer_bench.png").string();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(b.save(path, static_cast<int>(state.range(1))));
+    }
+    std::remove(path.c_str());
+    state.SetBytesProcessed(state.iterations() * state.range(0) * state.range(0) * 3);
+}
+BENCHMARK(bitmap_save)->ArgsProduct({{256, 1024}, {1, 6, 9}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Strips compressed on this many threads, against png_writer doing it all on one
+static void bitmap_write_png(benchmark::State& state) {
+    const auto b = make_gradient(2048);
+    for (auto _ : state) {
+        std::ostringstream out;
+        benchmark::DoNotOptimize(write_png(out, b.view(), {.threadCount = static_cast<unsigned int>(state.range(0))}));
+    }
+    state.SetBytesProcessed(state.iterations() * 2048 * 2048 * 3);
+}
+BENCHMARK(bitmap_write_png)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void bitmap_png_writer(benchmark::State& state) {
+    const auto b = make_gradient(2048);
+    for (auto _ : state) {
+        std::ostringstream out;
+        png_writer png{out, 2048, 2048};
+        png.write_rows(b.view());
+        benchmark::DoNotOptimize(png.finish());
+    }
+    state.SetBytesProcessed(state.iterations() * 2048 * 2048 * 3);
+}
+BENCHMARK(bitmap_png_writer)->Unit(benchmark::kMillisecond);
+
+static void bitmap_update_rgb8(benchmark::State& state) {
+    auto b = make_gradient(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        b.update_rgb8();
+        benchmark::DoNotOptimize(b.get_rgb8());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * state.range(0) * 3);
+}
+BENCHMARK(bitmap_update_rgb8)->Arg(1024);
@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include <affine.hpp>
+#include <mat.hpp>
+
+using namespace rt;
+
+namespace {
+
+const mat<4,4> MATRIX{
+    8, -5, 9, 2,
+    7, 5, 6, 1,
+    -6, 0, 9, 6,
+    -3, 0, -9, -4
+};
+
+} // namespace
+
+static void mat_multiply(benchmark::State& state) {
+    auto a = MATRIX;
+    auto b = mat<4,4>::make_translation(1, 2, 3) * mat<4,4>::make_scaled(2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        benchmark::DoNotOptimize(a * b);
+    }
+}
+BENCHMARK(mat_multiply);
+
+static void mat_determinant(benchmark::State& state) {
+    auto m = MATRIX;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(m.determinant());
+    }
+}
+BENCHMARK(mat_determinant);
+
+static void mat_inverse(benchmark::State& state) {
+    auto m = MATRIX;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(m.inverse());
+    }
+}
+BENCHMARK(mat_inverse);
+
+static void mat_inverse_cofactors(benchmark::State& state) {
+    auto m = MATRIX;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(m.inverse_cofactors());
+    }
+}
+BENCHMARK(mat_inverse_cofactors);
+
+static void mat_inverse_closed_form(benchmark::State& state) {
+    auto m = MATRIX;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(m.inverse_closed_form());
+    }
+}
+BENCHMARK(mat_inverse_closed_form);
+
+static void mat_inverse_simd(benchmark::State& state) {
+    auto m = MATRIX;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(m.inverse_simd());
+    }
+}
+BENCHMARK(mat_inverse_simd);
+
+static void mat_vec_multiply(benchmark::State& state) {
+    auto m = mat<4,4>::make_translation(1, 2, 3) * mat<4,4>::make_scaled(2);
+    auto v = vec::make_point(1, 2, 3);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(m * v);
+    }
+}
+BENCHMARK(mat_vec_multiply);
+
+static void affine_vec_multiply(benchmark::State& state) {
+    affine3x4 m{mat<4,4>::make_translation(1, 2, 3) * mat<4,4>::make_scaled(2)};
+    auto v = vec::make_point(1, 2, 3);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(m * v);
+    }
+}
+BENCHMARK(affine_vec_multiply);
+
+static void affine_inverse(benchmark::State& state) {
+    affine3x4 m{MATRIX};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(m.inverse());
+    }
+}
+BENCHMARK(affine_inverse);
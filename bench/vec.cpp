@@ -0,0 +1,36 @@
+#include <benchmark/benchmark.h>
+
+#include <vec.hpp>
+
+using namespace rt;
+
+static void vec_normalize(benchmark::State& state) {
+    auto v = vec::make_vector(1, 2, 3);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(v.normalize());
+    }
+}
+BENCHMARK(vec_normalize);
+
+static void vec_dot(benchmark::State& state) {
+    auto a = vec::make_vector(1, 2, 3);
+    auto b = vec::make_vector(4, -5, 6);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        benchmark::DoNotOptimize(a.dot(b));
+    }
+}
+BENCHMARK(vec_dot);
+
+static void vec_cross(benchmark::State& state) {
+    auto a = vec::make_vector(1, 2, 3);
+    auto b = vec::make_vector(4, -5, 6);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        benchmark::DoNotOptimize(a.cross(b));
+    }
+}
+BENCHMARK(vec_cross);
@@ -0,0 +1,113 @@
+#include <benchmark/benchmark.h>
+
+#include <world.hpp>
+
+using namespace rt;
+
+namespace {
+
+// Spheres spread over a wall in front of the camera, about half the rays hit something
+void fill(world& w, std::int64_t count) {
+    const auto side = static_cast<std::int64_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    for (std::int64_t i = 0; i < count; i++) {
+        const auto x = static_cast<float>(i % side) / static_cast<float>(side) * 20 - 10;
+        const auto y = static_cast<float>(i / side) / static_cast<float>(side) * 20 - 10;
+        w.add<sphere>(vec::make_point(x, y, static_cast<float>(i % 7)), vec::make_vector(10.f / static_cast<float>(side) * 0.7f));
+    }
+    w.rebuild();
+}
+
+const camera CAMERA{vec::make_point(0, 0, -20), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), 1.f, 64, 64};
+
+} // namespace
+
+static void sphere_intersections(benchmark::State& state) {
+    sphere s{0};
+    s.model.set_translation(vec::make_point(0, 0, 5));
+    ray r{vec::make_point(0, 0, 0), vec::make_vector(0.1f, 0, 1).normalize()};
+    std::array<intersection, object::MAX_INTERSECTIONS> hits;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(r);
+        benchmark::DoNotOptimize(s.intersections(r, hits));
+    }
+}
+BENCHMARK(sphere_intersections);
+
+static void sphere_closest_intersection(benchmark::State& state) {
+    sphere s{0};
+    s.model.set_translation(vec::make_point(0, 0, 5));
+    ray r{vec::make_point(0, 0, 0), vec::make_vector(0.1f, 0, 1).normalize()};
+    intersection hit;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(r);
+        benchmark::DoNotOptimize(s.closest_intersection(r, std::numeric_limits<float>::infinity(), hit));
+    }
+}
+BENCHMARK(sphere_closest_intersection);
+
+// Cycles through the rays of a 64x64 image, so hits and misses are mixed like in a real render
+static void world_get_visible_intersection(benchmark::State& state) {
+    world w;
+    fill(w, state.range(0));
+    std::vector<ray> rays;
+    for (std::size_t y = 0; y < CAMERA.get_height(); y++) {
+        for (std::size_t x = 0; x < CAMERA.get_width(); x++) {
+            rays.push_back(CAMERA.get_ray(static_cast<float>(x), static_cast<float>(y)));
+        }
+    }
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(w.get_visible_intersection(rays[i]));
+        i = (i + 1) % rays.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(world_get_visible_intersection)->RangeMultiplier(10)->Range(1, 10000);
+
+static void world_get_closest_intersections_packet(benchmark::State& state) {
+    world w;
+    fill(w, state.range(0));
+    std::vector<ray_packet> packets;
+    for (std::size_t y = 0; y < CAMERA.get_height(); y++) {
+        for (std::size_t x = 0; x < CAMERA.get_width(); x += ray_packet::SIZE) {
+            auto& packet = packets.emplace_back();
+            for (std::size_t lane = 0; lane < ray_packet::SIZE; lane++) {
+                packet.set(lane, CAMERA.get_ray(static_cast<float>(x + lane), static_cast<float>(y)));
+            }
+        }
+    }
+    std::array<std::optional<intersection>, ray_packet::SIZE> hits;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        w.get_closest_intersections(packets[i], hits);
+        benchmark::DoNotOptimize(hits);
+        i = (i + 1) % packets.size();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ray_packet::SIZE));
+}
+BENCHMARK(world_get_closest_intersections_packet)->RangeMultiplier(10)->Range(1, 10000);
+
+// Resolution as the argument, on one thread so results don't depend on the machine's core count
+static void world_render(benchmark::State& state) {
+    world w;
+    fill(w, 1000);
+    const auto size = static_cast<std::size_t>(state.range(0));
+    camera cam{CAMERA.get_origin(), CAMERA.get_forward(), CAMERA.get_up(), CAMERA.get_fov(), size, size};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(w.render(cam, {.threadCount = 1}));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+BENCHMARK(world_render)->Arg(64)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+static void world_render_parallel(benchmark::State& state) {
+    world w;
+    fill(w, 1000);
+    const auto size = static_cast<std::size_t>(state.range(0));
+    camera cam{CAMERA.get_origin(), CAMERA.get_forward(), CAMERA.get_up(), CAMERA.get_fov(), size, size};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(w.render(cam));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+BENCHMARK(world_render_parallel)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <png.hpp>
+#include <scene.hpp>
+
+namespace {
+
+constexpr std::string_view USAGE = R"(usage: raytracer_cli [options] [scene]
+
+Renders the scene file (or a built in scene if none is given) and writes a PNG.
+
+options:
+  -o, --output <file>     image to write (default: render.png)
+  -W, --width <pixels>    image width (default: 800)
+  -H, --height <pixels>   image height (default: 600)
+  -t, --threads <count>   render threads, 0 uses every hardware thread (default: 0)
+  -s, --tile-size <px>    side of the square tiles handed to threads (default: 32)
+  -r, --repeat <count>    render this many times and report the fastest and average (default: 1)
+  -m, --scratch <dir>     keep the image in a scratch file in dir instead of memory, for images larger than RAM
+  -S, --stream            encode rows while the rest of the image renders, only a few rows are ever in memory
+  -z, --level <0-9>       PNG compression, 0 stores, 1 is the fastest and 9 the smallest (default: 6)
+  -h, --help              show this message
+)";
+
+template<typename T>
+bool parse_number(std::string_view text, T& out) {
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), out);
+    return result.ec == std::errc{} && result.ptr == text.data() + text.size();
+}
+
+double milliseconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string scenePath;
+    std::string outputPath = "render.png";
+    std::size_t width = 800;
+    std::size_t height = 600;
+    rt::render_options options;
+    int repeat = 1;
+    std::optional<std::string> scratchDirectory;
+    bool stream = false;
+    int level = rt::deflate_encoder::DEFAULT_LEVEL;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            std::fputs(USAGE.data(), stdout);
+            return 0;
+        }
+        if (!arg.starts_with('-')) {
+            scenePath = arg;
+            continue;
+        }
+        if (arg == "-S" || arg == "--stream") {
+            stream = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "%s needs a value\n", argv[i]);
+            return 1;
+        }
+        const std::string_view value = argv[++i];
+        bool valid = true;
+        if (arg == "-o" || arg == "--output") {
+            outputPath = value;
+        } else if (arg == "-W" || arg == "--width") {
+            valid = parse_number(value, width) && width > 0;
+        } else if (arg == "-H" || arg == "--height") {
+            valid = parse_number(value, height) && height > 0;
+        } else if (arg == "-t" || arg == "--threads") {
+            valid = parse_number(value, options.threadCount);
+        } else if (arg == "-s" || arg == "--tile-size") {
+            valid = parse_number(value, options.tileSize) && options.tileSize > 0;
+        } else if (arg == "-r" || arg == "--repeat") {
+            valid = parse_number(value, repeat) && repeat > 0;
+        } else if (arg == "-m" || arg == "--scratch") {
+            scratchDirectory = value;
+        } else if (arg == "-z" || arg == "--level") {
+            valid = parse_number(value, level) && level >= 0 && level <= 9;
+        } else {
+            std::fprintf(stderr, "unknown option %s\n\n%s", argv[i - 1], USAGE.data());
+            return 1;
+        }
+        if (!valid) {
+            std::fprintf(stderr, "invalid value '%s' for %s\n", argv[i], argv[i - 1]);
+            return 1;
+        }
+    }
+
+    if (stream && scratchDirectory) {
+        std::fprintf(stderr, "--stream and --scratch can't be combined\n");
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    rt::scene scene;
+    if (scenePath.empty()) {
+        scene.make_default();
+    } else if (std::string error; !scene.load(scenePath, error)) {
+        std::fprintf(stderr, "%s: %s\n", scenePath.c_str(), error.c_str());
+        return 1;
+    }
+    const auto loadTime = milliseconds_since(start);
+
+    // Built up front so it isn't counted as render time
+    start = std::chrono::steady_clock::now();
+    scene.get_world().rebuild();
+    const auto buildTime = milliseconds_since(start);
+
+    const auto cam = scene.make_camera(width, height);
+    std::optional<rt::bitmap> image;
+    rt::tiled_bitmap tiledImage;
+    if (std::string error; scratchDirectory && !tiledImage.create(width, height, error, options.tileSize, *scratchDirectory)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    double fastest = 0;
+    double total = 0;
+    for (int i = 0; i < repeat; i++) {
+        start = std::chrono::steady_clock::now();
+        if (stream) {
+            std::ofstream file{outputPath, std::ios::binary};
+            rt::png_writer png{file, width, height, level};
+            scene.get_world().render_rows(cam, [&](rt::const_bitmap_view rows, std::size_t) {
+                png.write_rows(rows);
+            }, options);
+            if (!png.finish()) {
+                std::fprintf(stderr, "could not write %s\n", outputPath.c_str());
+                return 1;
+            }
+        } else if (scratchDirectory) {
+            scene.get_world().render(cam, tiledImage, options);
+        } else {
+            image = scene.get_world().render(cam, options);
+        }
+        const auto renderTime = milliseconds_since(start);
+        fastest = i == 0 ? renderTime : std::min(fastest, renderTime);
+        total += renderTime;
+    }
+
+    start = std::chrono::steady_clock::now();
+    if (!stream && !(scratchDirectory ? tiledImage.save(outputPath, level) : image->save(outputPath, level))) {
+        std::fprintf(stderr, "could not write %s\n", outputPath.c_str());
+        return 1;
+    }
+    const auto saveTime = milliseconds_since(start);
+
+    // Tiles are traced by the global pool and the rendering thread, asking for more threads than that doesn't add any
+    const auto poolThreads = rt::thread_pool::get_global().get_thread_count();
+    const auto threads = options.threadCount ? std::min(options.threadCount, poolThreads + 1) : poolThreads;
+    const auto pixels = static_cast<double>(width) * static_cast<double>(height);
+    std::printf("objects:  %zu\n", scene.get_world().get_objects().size());
+    std::printf("image:    %zux%zu, %u threads, %zu px tiles\n", width, height, threads, options.tileSize);
+    std::printf("load:     %.2f ms\n", loadTime);
+    std::printf("build:    %.2f ms\n", buildTime);
+    if (repeat > 1) {
+        std::printf("render:   %.2f ms fastest, %.2f ms average over %d runs\n", fastest, total / repeat, repeat);
+    } else {
+        std::printf("render:   %.2f ms\n", fastest);
+    }
+    std::printf("rays:     %.2f M/s\n", pixels / fastest / 1000);
+    if (stream) {
+        std::printf("save:     during render (%s)\n", outputPath.c_str());
+    } else {
+        std::printf("save:     %.2f ms (%s)\n", saveTime, outputPath.c_str());
+    }
+    return 0;
+}
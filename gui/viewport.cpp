@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstring>
+#include <QPainter>
+#include "viewport.hpp"
+
+rt_viewport::rt_viewport(QWidget* parent)
+        : QWidget(parent) {
+    this->setMinimumSize(64, 64);
+    // Every pixel is drawn from the image, so Qt doesn't need to clear the background first
+    this->setAttribute(Qt::WA_OpaquePaintEvent);
+
+    QObject::connect(this, &rt_viewport::tile_rendered, this, &rt_viewport::update_tile, Qt::QueuedConnection);
+    QObject::connect(this, &rt_viewport::render_finished, this, [&](quint64 renderID, const QImage& pixels, double seconds) {
+        if (renderID != this->currentRender)
+            return;
+        this->image = pixels;
+        this->update();
+        this->rendering = false;
+        emit this->render_complete(seconds);
+    }, Qt::QueuedConnection);
+
+    this->resizeTimer.setSingleShot(true);
+    this->resizeTimer.setInterval(100);
+    QObject::connect(&this->resizeTimer, &QTimer::timeout, this, [&] {
+        this->render();
+    });
+}
+
+rt_viewport::~rt_viewport() {
+    // Render threads emit from this object, so they have to be gone before it is. This is the one place the UI thread
+    // waits for them, and only for the tiles they are tracing right now.
+    this->stop_render();
+    this->stopping.clear();
+}
+
+void rt_viewport::set_scene(std::unique_ptr<rt::scene> newScene) {
+    this->stop_render();
+    this->scene = std::move(newScene);
+    this->render();
+}
+
+void rt_viewport::render() {
+    this->stop_render();
+    this->currentRender++;
+    if (!this->scene || this->width() <= 0 || this->height() <= 0) {
+        this->image = QImage{};
+        this->update();
+        return;
+    }
+
+    this->image = QImage{this->size(), QImage::Format_RGB888};
+    this->image.fill(Qt::black);
+    this->rendering = true;
+
+    const auto cam = this->scene->make_camera(static_cast<std::size_t>(this->width()), static_cast<std::size_t>(this->height()));
+    this->worker.exited = std::make_shared<std::atomic<bool>>(false);
+    this->worker.thread = std::jthread{[this, cam, renderID = this->currentRender, scene = this->scene, exited = this->worker.exited](std::stop_token stop) {
+        const auto start = std::chrono::steady_clock::now();
+        auto frame = scene->get_world().render_progressive(cam, [&](const rt::bitmap& pixels, const rt::tile& dirty) {
+            // The bitmap already has the tile in QImage's layout, but while passes are running the rows are still
+            // copied out, because the next pass writes to them again while the UI thread may still be drawing
+            const QRect rect{static_cast<int>(dirty.x), static_cast<int>(dirty.y), static_cast<int>(dirty.width), static_cast<int>(dirty.height)};
+            QImage tile{rect.size(), QImage::Format_RGB888};
+            const auto* rgb8 = pixels.get_rgb8() + pixels.get_rgb8_stride() * dirty.y + dirty.x * 3;
+            for (int y = 0; y < rect.height(); y++) {
+                std::memcpy(tile.scanLine(y), rgb8 + pixels.get_rgb8_stride() * static_cast<std::size_t>(y), dirty.width * 3);
+            }
+            emit this->tile_rendered(renderID, tile, rect);
+        }, {.updateRgb8 = true}, stop);
+        if (!stop.stop_requested()) {
+            // Nothing writes to the finished frame anymore, so it is shown without a copy. The QImage owns the bitmap
+            // and frees it once the last copy of the image is gone.
+            auto* finished = new rt::bitmap{std::move(frame)};
+            const QImage pixels{finished->get_rgb8(), static_cast<int>(finished->get_width()), static_cast<int>(finished->get_height()),
+                                static_cast<qsizetype>(finished->get_rgb8_stride()), QImage::Format_RGB888,
+                                [](void* info) { delete static_cast<rt::bitmap*>(info); }, finished};
+            emit this->render_finished(renderID, pixels, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        exited->store(true, std::memory_order_release);
+    }};
+}
+
+void rt_viewport::stop_render() {
+    // Whatever an older render still emits carries its renderID and is dropped, so there is no need to wait for it
+    std::erase_if(this->stopping, [](const render_thread& r) {
+        return r.exited->load(std::memory_order_acquire);
+    });
+    if (this->worker.thread.joinable()) {
+        this->worker.thread.request_stop();
+        this->stopping.push_back(std::move(this->worker));
+        this->worker = {};
+    }
+    this->rendering = false;
+}
+
+bool rt_viewport::is_rendering() const {
+    return this->rendering;
+}
+
+void rt_viewport::paintEvent(QPaintEvent* event) {
+    QPainter painter{this};
+    painter.fillRect(this->rect(), Qt::black);
+    painter.drawImage(0, 0, this->image);
+}
+
+void rt_viewport::resizeEvent(QResizeEvent* event) {
+    QWidget::resizeEvent(event);
+    this->resizeTimer.start();
+}
+
+void rt_viewport::update_tile(quint64 renderID, const QImage& pixels, const QRect& dirty) {
+    if (renderID != this->currentRender)
+        return;
+    QPainter painter{&this->image};
+    painter.drawImage(dirty.topLeft(), pixels);
+    this->update(dirty);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <QImage>
+#include <QTimer>
+#include <QWidget>
+#include <scene.hpp>
+
+// Shows the scene, rendering it progressively on a worker thread whenever the scene or the widget size changes
+class rt_viewport : public QWidget {
+    Q_OBJECT;
+
+public:
+    explicit rt_viewport(QWidget* parent = nullptr);
+
+    ~rt_viewport() override;
+
+    void set_scene(std::unique_ptr<rt::scene> newScene);
+
+    // Starts over from the coarsest pass, stopping the render in progress
+    void render();
+
+    // Returns right away, the render finishes the tiles it is tracing in the background and its results are dropped
+    void stop_render();
+
+    [[nodiscard]] bool is_rendering() const;
+
+signals:
+    // Emitted from render threads, connected with a queued connection so the image is only touched on the UI thread
+    void tile_rendered(quint64 renderID, const QImage& pixels, const QRect& dirty);
+
+    // pixels is the finished frame, wrapping the render's own 8 bit copy
+    void render_finished(quint64 renderID, const QImage& pixels, double seconds);
+
+    // Emitted on the UI thread once the last tile of the current render is in the image
+    void render_complete(double seconds);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    void update_tile(quint64 renderID, const QImage& pixels, const QRect& dirty);
+
+    struct render_thread {
+        std::jthread thread;
+        // Set by the thread as it exits, joining it afterwards doesn't block
+        std::shared_ptr<std::atomic<bool>> exited;
+    };
+
+    // Shared with the render threads, so a stopped render can still finish on the scene it started with
+    std::shared_ptr<rt::scene> scene;
+    QImage image;
+    render_thread worker;
+    // Stopped renders still finishing their tiles, joined once they are done
+    std::vector<render_thread> stopping;
+    // Bumped by every render, tiles still queued from an older render are dropped
+    quint64 currentRender = 0;
+    bool rendering = false;
+    // Dragging the window edge resizes many times a second, only render once it settles
+    QTimer resizeTimer;
+};
@@ -1,11 +1,15 @@
 #include <QApplication>
 #include <QCloseEvent>
 #include <QDockWidget>
+#include <QFileDialog>
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QShortcut>
+#include <QStatusBar>
 #include <QStyle>
 #include <QToolBar>
+#include <scene.hpp>
+#include "viewport.hpp"
 #include "window.hpp"
 
 rt_window::rt_window(QWidget* parent)
@@ -14,6 +18,12 @@ rt_window::rt_window(QWidget* parent)
     this->setWindowIcon(QIcon(":/logo.png"));
     this->setMinimumSize(300, 300);
 
+    this->viewport = new rt_viewport{this};
+    this->setCentralWidget(this->viewport);
+    QObject::connect(this->viewport, &rt_viewport::render_complete, this, [&](double seconds) {
+        this->statusBar()->showMessage(tr("Rendered in %1 ms").arg(seconds * 1000, 0, 'f', 1));
+    });
+
     auto* fileMenu = this->menuBar()->addMenu(tr("File"));
     fileMenu->addAction(this->style()->standardIcon(QStyle::SP_FileIcon), "New", [&] {
         this->new_file();
@@ -32,6 +42,20 @@ rt_window::rt_window(QWidget* parent)
         this->close();
     });
 
+    auto* renderMenu = this->menuBar()->addMenu(tr("Render"));
+    auto* renderAction = renderMenu->addAction(this->style()->standardIcon(QStyle::SP_BrowserReload), "Render", [&] {
+        this->statusBar()->showMessage(tr("Rendering..."));
+        this->viewport->render();
+    });
+    renderAction->setShortcut(Qt::Key_F5);
+    auto* stopAction = renderMenu->addAction(this->style()->standardIcon(QStyle::SP_BrowserStop), "Stop", [&] {
+        if (!this->viewport->is_rendering())
+            return;
+        this->viewport->stop_render();
+        this->statusBar()->showMessage(tr("Render stopped"));
+    });
+    stopAction->setShortcut(Qt::Key_Escape);
+
     auto* helpMenu = this->menuBar()->addMenu(tr("Help"));
     helpMenu->addAction(this->style()->standardIcon(QStyle::SP_DialogHelpButton), "About Me", [&] {
         QMessageBox::about(this, tr("About"), "raytracer_gui\n\nmade by craftablescience 2023");
@@ -39,6 +63,8 @@ rt_window::rt_window(QWidget* parent)
     helpMenu->addAction(this->style()->standardIcon(QStyle::SP_DialogHelpButton), "About Qt", [&] {
         QMessageBox::aboutQt(this);
     });
+
+    this->new_file();
 }
 
 void rt_window::closeEvent(QCloseEvent* event) {
@@ -53,22 +79,34 @@ void rt_window::closeEvent(QCloseEvent* event) {
     }
 }
 
-void rt_window::new_file() {}
+void rt_window::new_file() {
+    if (!this->save_if_wanted())
+        return;
+
+    auto scene = std::make_unique<rt::scene>();
+    scene->make_default();
+    this->viewport->set_scene(std::move(scene));
+    this->statusBar()->showMessage(tr("Rendering..."));
+    this->unmark_modified();
+}
 
 void rt_window::open_file() {
-    /*
-    if (!ask_save())
+    if (!this->save_if_wanted())
         return;
 
-    auto file =
-            QFileDialog::getOpenFileName(this, tr("Open VTF"), QString(), "Valve Texture Format (*.vtf);;All files (*.*)");
+    auto file = QFileDialog::getOpenFileName(this, tr("Open Scene"), QString(), "Scene (*.scene);;All files (*.*)");
     if (file.isEmpty())
         return;
 
-    if (!document()->load_file(file.toUtf8().data())) {
-        QMessageBox::warning(this, tr("Error"), tr("Could not open file!"));
+    auto scene = std::make_unique<rt::scene>();
+    std::string error;
+    if (!scene->load(file.toStdString(), error)) {
+        QMessageBox::warning(this, tr("Error"), tr("Could not open scene!\n\n%1").arg(QString::fromStdString(error)));
+        return;
     }
-    */
+    this->viewport->set_scene(std::move(scene));
+    this->statusBar()->showMessage(tr("Rendering..."));
+    this->unmark_modified();
 }
 
 void rt_window::save_file(bool saveAs /*= false*/) const {
@@ -114,6 +152,18 @@ bool rt_window::is_modified() const {
     return this->windowTitle().endsWith('*');
 }
 
+bool rt_window::save_if_wanted() {
+    if (!this->is_modified())
+        return true;
+
+    auto r = this->ask_for_save();
+    if (r == QMessageBox::Cancel)
+        return false;
+    if (r == QMessageBox::Save)
+        this->save_file();
+    return true;
+}
+
 int rt_window::ask_for_save() {
     auto* msgBox = new QMessageBox(QMessageBox::Icon::Question, tr("Quit without saving?"),
                                    tr("You have unsaved changes. Would you like to save?"),
@@ -3,6 +3,8 @@
 #include <array>
 #include <QMainWindow>
 
+class rt_viewport;
+
 class rt_window : public QMainWindow {
     Q_OBJECT;
 
@@ -25,4 +27,10 @@ protected:
     [[nodiscard]] bool is_modified() const;
 
     [[nodiscard]] int ask_for_save();
+
+    // Asks about unsaved changes before they are thrown away, false if the user cancelled
+    [[nodiscard]] bool save_if_wanted();
+
+private:
+    rt_viewport* viewport;
 };
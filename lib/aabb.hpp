@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+#include "ray.hpp"
+
+namespace rt {
+
+// Axis aligned bounding box, default constructed boxes are empty
+struct aabb {
+    vec min = vec::make_point(std::numeric_limits<float>::infinity());
+    vec max = vec::make_point(-std::numeric_limits<float>::infinity());
+
+    constexpr aabb() = default;
+    constexpr aabb(vec min_, vec max_) : min(min_), max(max_) {}
+
+    [[nodiscard]] constexpr bool is_empty() const {
+        return this->min.x > this->max.x || this->min.y > this->max.y || this->min.z > this->max.z;
+    }
+
+    constexpr void expand(vec point) {
+        this->min = vec::make_point(std::min(this->min.x, point.x), std::min(this->min.y, point.y), std::min(this->min.z, point.z));
+        this->max = vec::make_point(std::max(this->max.x, point.x), std::max(this->max.y, point.y), std::max(this->max.z, point.z));
+    }
+    constexpr void expand(const aabb& other) {
+        this->min = vec::make_point(std::min(this->min.x, other.min.x), std::min(this->min.y, other.min.y), std::min(this->min.z, other.min.z));
+        this->max = vec::make_point(std::max(this->max.x, other.max.x), std::max(this->max.y, other.max.y), std::max(this->max.z, other.max.z));
+    }
+    [[nodiscard]] constexpr aabb merge(const aabb& other) const {
+        aabb out = *this;
+        out.expand(other);
+        return out;
+    }
+
+    // Bounds of this box after transformation, tight for scale and translation, conservative for rotation and shear
+    // https://www.realtimerendering.com/resources/GraphicsGems/gems/TransBox.c
+    [[nodiscard]] constexpr aabb transform(const affine3x4& transformation) const {
+        if (this->is_empty()) {
+            return {};
+        }
+        const float lower[3] {this->min.x, this->min.y, this->min.z};
+        const float upper[3] {this->max.x, this->max.y, this->max.z};
+        float outLower[3] {transformation(0, 3), transformation(1, 3), transformation(2, 3)};
+        float outUpper[3] {transformation(0, 3), transformation(1, 3), transformation(2, 3)};
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                const float a = transformation(i, j) * lower[j];
+                const float b = transformation(i, j) * upper[j];
+                outLower[i] += std::min(a, b);
+                outUpper[i] += std::max(a, b);
+            }
+        }
+        return {vec::make_point(outLower[0], outLower[1], outLower[2]), vec::make_point(outUpper[0], outUpper[1], outUpper[2])};
+    }
+
+    [[nodiscard]] constexpr vec centroid() const {
+        return vec::make_point((this->min.x + this->max.x) / 2, (this->min.y + this->max.y) / 2, (this->min.z + this->max.z) / 2);
+    }
+    [[nodiscard]] constexpr vec extent() const {
+        return this->max - this->min;
+    }
+    [[nodiscard]] constexpr float surface_area() const {
+        if (this->is_empty()) {
+            return 0.f;
+        }
+        const auto e = this->extent();
+        return 2 * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    // Slab test, true if the ray passes through the box somewhere in [0, maxDistance)
+    [[nodiscard]] constexpr bool intersects(ray r, float maxDistance = std::numeric_limits<float>::infinity()) const {
+        float entry = 0.f;
+        float exit = maxDistance;
+        const float origin[3] {r.origin.x, r.origin.y, r.origin.z};
+        const float direction[3] {r.direction.x, r.direction.y, r.direction.z};
+        const float lower[3] {this->min.x, this->min.y, this->min.z};
+        const float upper[3] {this->max.x, this->max.y, this->max.z};
+        for (int i = 0; i < 3; i++) {
+            const float inverse = 1.f / direction[i];
+            const float t1 = (lower[i] - origin[i]) * inverse;
+            const float t2 = (upper[i] - origin[i]) * inverse;
+            // A ray lying in one of the slab's planes gets 0 * inf = NaN there, that slab doesn't limit it
+            const bool inPlane = t1 != t1 || t2 != t2; // NOLINT(misc-redundant-expression), std::isunordered isn't constexpr
+            entry = inPlane ? entry : std::max(entry, std::min(t1, t2));
+            exit = inPlane ? exit : std::min(exit, std::max(t1, t2));
+        }
+        return entry <= exit;
+    }
+
+    [[nodiscard]] constexpr bool operator==(const aabb& other) const {
+        return this->min == other.min && this->max == other.max;
+    }
+};
+
+} // namespace rt
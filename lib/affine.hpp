@@ -0,0 +1,134 @@
+#pragma once
+
+#include "mat.hpp"
+
+namespace rt {
+
+// A 4x4 matrix whose bottom row is always 0 0 0 1, only the top three rows are stored
+struct affine3x4 {
+    constexpr affine3x4()
+            : values{1, 0, 0, 0,
+                     0, 1, 0, 0,
+                     0, 0, 1, 0} {}
+    template<typename... Values>
+    requires (sizeof...(Values) == 12)
+    explicit constexpr affine3x4(Values... vals)
+            : values{static_cast<float>(vals)...} {}
+    // The bottom row of the matrix is discarded
+    explicit constexpr affine3x4(const mat<4, 4>& m) {
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 4; j++) {
+                (*this)(i, j) = m(i, j);
+            }
+        }
+    }
+
+    [[nodiscard]] static constexpr affine3x4 make_identity() {
+        return {};
+    }
+
+    [[nodiscard]] constexpr mat<4, 4> to_mat() const {
+        mat<4, 4> out = mat<4, 4>::make_identity();
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 4; j++) {
+                out(i, j) = this->get(i, j);
+            }
+        }
+        return out;
+    }
+
+    [[nodiscard]] constexpr float determinant() const {
+        return this->get(0, 0) * (this->get(1, 1) * this->get(2, 2) - this->get(1, 2) * this->get(2, 1)) -
+               this->get(0, 1) * (this->get(1, 0) * this->get(2, 2) - this->get(1, 2) * this->get(2, 0)) +
+               this->get(0, 2) * (this->get(1, 0) * this->get(2, 1) - this->get(1, 1) * this->get(2, 0));
+    }
+
+    [[nodiscard]] constexpr bool invertible() const {
+        return this->determinant() != 0.f;
+    }
+
+    // Inverts the 3x3 linear part, the translation becomes -inverse(linear) * translation
+    [[nodiscard]] constexpr affine3x4 inverse() const {
+        const float determinant_ = this->determinant();
+        if (determinant_ == 0.f) {
+            return affine3x4::make_identity();
+        }
+        const float inv = 1.f / determinant_;
+        affine3x4 out;
+        out(0, 0) = (this->get(1, 1) * this->get(2, 2) - this->get(1, 2) * this->get(2, 1)) * inv;
+        out(0, 1) = (this->get(0, 2) * this->get(2, 1) - this->get(0, 1) * this->get(2, 2)) * inv;
+        out(0, 2) = (this->get(0, 1) * this->get(1, 2) - this->get(0, 2) * this->get(1, 1)) * inv;
+        out(1, 0) = (this->get(1, 2) * this->get(2, 0) - this->get(1, 0) * this->get(2, 2)) * inv;
+        out(1, 1) = (this->get(0, 0) * this->get(2, 2) - this->get(0, 2) * this->get(2, 0)) * inv;
+        out(1, 2) = (this->get(0, 2) * this->get(1, 0) - this->get(0, 0) * this->get(1, 2)) * inv;
+        out(2, 0) = (this->get(1, 0) * this->get(2, 1) - this->get(1, 1) * this->get(2, 0)) * inv;
+        out(2, 1) = (this->get(0, 1) * this->get(2, 0) - this->get(0, 0) * this->get(2, 1)) * inv;
+        out(2, 2) = (this->get(0, 0) * this->get(1, 1) - this->get(0, 1) * this->get(1, 0)) * inv;
+        for (int i = 0; i < 3; i++) {
+            out(i, 3) = -(out(i, 0) * this->get(0, 3) + out(i, 1) * this->get(1, 3) + out(i, 2) * this->get(2, 3));
+        }
+        return out;
+    }
+
+    // Transposes the 3x3 linear part and drops the translation, which only makes sense for vectors
+    [[nodiscard]] constexpr affine3x4 transpose_linear() const {
+        return affine3x4{
+            this->get(0, 0), this->get(1, 0), this->get(2, 0), 0,
+            this->get(0, 1), this->get(1, 1), this->get(2, 1), 0,
+            this->get(0, 2), this->get(1, 2), this->get(2, 2), 0
+        };
+    }
+
+    constexpr void set(float value, int row, int col) {
+        this->values[row * 4 + col] = value;
+    }
+    [[nodiscard]] constexpr float get(int row, int col) const {
+        return this->values[row * 4 + col];
+    }
+    [[nodiscard]] constexpr const float& operator()(int row, int col) const {
+        return this->values[row * 4 + col];
+    }
+    [[nodiscard]] constexpr float& operator()(int row, int col) {
+        return this->values[row * 4 + col];
+    }
+
+    [[nodiscard]] constexpr affine3x4 operator*(const affine3x4& other) const {
+        affine3x4 out;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 4; j++) {
+                out(i, j) = this->get(i, 0) * other.get(0, j) + this->get(i, 1) * other.get(1, j) + this->get(i, 2) * other.get(2, j);
+            }
+            out(i, 3) += this->get(i, 3);
+        }
+        return out;
+    }
+    constexpr void operator*=(const affine3x4& other) {
+        *this = *this * other;
+    }
+    // The bottom row leaves w untouched, so points stay points and vectors stay vectors
+    [[nodiscard]] constexpr vec operator*(vec other) const {
+        return {
+            this->get(0, 0) * other.x + this->get(0, 1) * other.y + this->get(0, 2) * other.z + this->get(0, 3) * other.w,
+            this->get(1, 0) * other.x + this->get(1, 1) * other.y + this->get(1, 2) * other.z + this->get(1, 3) * other.w,
+            this->get(2, 0) * other.x + this->get(2, 1) * other.y + this->get(2, 2) * other.z + this->get(2, 3) * other.w,
+            other.w
+        };
+    }
+
+    [[nodiscard]] constexpr bool operator==(const affine3x4& other) const {
+        for (int i = 0; i < 12; i++) {
+            if (!float_eq(this->values[i], other.values[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    [[nodiscard]] constexpr bool operator==(const mat<4, 4>& other) const {
+        return this->to_mat() == other;
+    }
+
+private:
+    float values[12];
+};
+
+} // namespace rt
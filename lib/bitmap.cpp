@@ -1,36 +1,25 @@
 #include "bitmap.hpp"
 
-#include <algorithm>
-#include <iterator>
-#include <utility>
+#include <filesystem>
+#include <fstream>
 
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "thirdparty/stb_image_write.h"
+#include "png.hpp"
 
 using namespace rt;
 
-std::vector<unsigned char> bitmap::get_raw_png() const {
-    std::vector<unsigned char> buffer(this->width * this->height * 3);
-    for (int i = 0, j = 0; i < this->width * this->height * 3; i += 3, j += 1) {
-        buffer[i+0] = std::clamp<unsigned char>(static_cast<unsigned char>(255 * this->pixels[j].r), 0, 255);
-        buffer[i+1] = std::clamp<unsigned char>(static_cast<unsigned char>(255 * this->pixels[j].g), 0, 255);
-        buffer[i+2] = std::clamp<unsigned char>(static_cast<unsigned char>(255 * this->pixels[j].b), 0, 255);
+void bitmap::update_rgb8(std::size_t x, std::size_t y, std::size_t width_, std::size_t height_) {
+    this->allocate_rgb8();
+    const auto stride = this->get_rgb8_stride();
+    for (std::size_t row = y; row < y + height_; row++) {
+        to_rgb8({this->pixels.get() + this->width * row + x, width_}, this->rgb8.get() + stride * row + x * 3);
     }
-    int pngBufferSize;
-    auto* pngBuffer = stbi_write_png_to_mem(buffer.data(), this->width * 3, this->width, this->height, 3, &pngBufferSize);
-    std::vector<unsigned char> out(pngBufferSize);
-    std::copy(pngBuffer, pngBuffer + pngBufferSize, std::back_inserter(out));
-    STBIW_FREE(pngBuffer);
-    return out;
 }
 
-bool bitmap::save(std::string_view filepath) const {
-    std::vector<std::byte> buffer;
-    buffer.resize(this->width * this->height * 3);
-    for (int i = 0, j = 0; i < this->width * this->height * 3; i += 3, j += 1) {
-        buffer[i+0] = std::clamp(static_cast<std::byte>(255 * this->pixels[j].r), static_cast<std::byte>(0), static_cast<std::byte>(255));
-        buffer[i+1] = std::clamp(static_cast<std::byte>(255 * this->pixels[j].g), static_cast<std::byte>(0), static_cast<std::byte>(255));
-        buffer[i+2] = std::clamp(static_cast<std::byte>(255 * this->pixels[j].b), static_cast<std::byte>(0), static_cast<std::byte>(255));
-    }
-    return stbi_write_png(filepath.data(), this->width, this->height, 3, buffer.data(), this->width * 3);
+std::vector<unsigned char> bitmap::get_raw_png(int level) const {
+    return encode_png(this->view(), {.level = level});
+}
+
+bool bitmap::save(std::string_view filepath, int level) const {
+    std::ofstream file{std::filesystem::path{filepath}, std::ios::binary};
+    return write_png(file, this->view(), {.level = level});
 }
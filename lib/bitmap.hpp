@@ -1,56 +1,178 @@
 #pragma once
 
+#include <cstddef>
+#include <cstring>
 #include <memory>
+#include <span>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "color.hpp"
+#include "deflate.hpp"
 
 namespace rt {
 
+// Window onto a rectangle of pixels owned by something else, pixel (0, 0) is the rectangle's top left corner.
+// Copying a view copies the window, never the pixels.
+template<typename T>
+requires std::is_same_v<std::remove_const_t<T>, color>
+class basic_bitmap_view {
+public:
+    constexpr basic_bitmap_view() = default;
+    constexpr basic_bitmap_view(T* data_, std::size_t width_, std::size_t height_, std::size_t stride_)
+            : data(data_)
+            , width(width_)
+            , height(height_)
+            , stride(stride_) {}
+    // Mutable views convert to const ones
+    template<typename U>
+    requires std::is_same_v<T, const U>
+    constexpr basic_bitmap_view(basic_bitmap_view<U> other) // NOLINT(google-explicit-constructor)
+            : basic_bitmap_view(other.row(0).data(), other.get_width(), other.get_height(), other.get_stride()) {}
+
+    [[nodiscard]] constexpr std::size_t get_width() const {
+        return this->width;
+    }
+    [[nodiscard]] constexpr std::size_t get_height() const {
+        return this->height;
+    }
+    // Pixels from the start of one row to the start of the next
+    [[nodiscard]] constexpr std::size_t get_stride() const {
+        return this->stride;
+    }
+
+    [[nodiscard]] constexpr T& operator()(std::size_t x, std::size_t y) const {
+        return this->data[this->stride * y + x];
+    }
+    [[nodiscard]] constexpr color get_pixel(std::size_t x, std::size_t y) const {
+        return (*this)(x, y);
+    }
+    constexpr void set_pixel(color c, std::size_t x, std::size_t y) const requires (!std::is_const_v<T>) {
+        (*this)(x, y) = c;
+    }
+    [[nodiscard]] constexpr std::span<T> row(std::size_t y) const {
+        return {this->data + this->stride * y, this->width};
+    }
+
+    // Rectangle inside this one, the caller keeps it in bounds
+    [[nodiscard]] constexpr basic_bitmap_view subview(std::size_t x, std::size_t y, std::size_t width_, std::size_t height_) const {
+        return {this->data + this->stride * y + x, width_, height_, this->stride};
+    }
+
+private:
+    T* data = nullptr;
+    std::size_t width = 0;
+    std::size_t height = 0;
+    std::size_t stride = 0;
+};
+
+using bitmap_view = basic_bitmap_view<color>;
+using const_bitmap_view = basic_bitmap_view<const color>;
+
 struct bitmap {
-    bitmap(short width_, short height_)
+    bitmap(std::size_t width_, std::size_t height_)
             : width(width_)
             , height(height_)
             , pixels(std::make_unique<color[]>(width_ * height_)) {}
     bitmap(const bitmap& other) {
-        this->width = other.width;
-        this->height = other.height;
-        this->pixels = std::make_unique<color[]>(other.width * other.height);
-        std::memcpy(this->pixels.get(), other.pixels.get(), sizeof(color) * this->width * this->height);
+        *this = other;
     }
     bitmap& operator=(const bitmap& other) {
+        if (this == &other) {
+            return *this;
+        }
         this->width = other.width;
         this->height = other.height;
         this->pixels = std::make_unique<color[]>(other.width * other.height);
         std::memcpy(this->pixels.get(), other.pixels.get(), sizeof(color) * this->width * this->height);
+        this->rgb8.reset();
+        if (other.rgb8) {
+            this->rgb8 = std::make_unique<unsigned char[]>(get_rgb8_stride(other.width) * other.height);
+            std::memcpy(this->rgb8.get(), other.rgb8.get(), get_rgb8_stride(this->width) * this->height);
+        }
+        return *this;
+    }
+    // Moved from bitmaps are empty
+    bitmap(bitmap&& other) noexcept
+            : width(std::exchange(other.width, 0))
+            , height(std::exchange(other.height, 0))
+            , pixels(std::move(other.pixels))
+            , rgb8(std::move(other.rgb8)) {}
+    bitmap& operator=(bitmap&& other) noexcept {
+        this->width = std::exchange(other.width, 0);
+        this->height = std::exchange(other.height, 0);
+        this->pixels = std::move(other.pixels);
+        this->rgb8 = std::move(other.rgb8);
         return *this;
     }
 
-    [[nodiscard]] short get_width() const {
+    [[nodiscard]] std::size_t get_width() const {
         return this->width;
     }
-    [[nodiscard]] short get_height() const {
+    [[nodiscard]] std::size_t get_height() const {
         return this->height;
     }
 
-    void set_pixel(color c, short width_, short height_) {
-        this->pixels[this->width * height_ + width_] = c;
+    void set_pixel(color c, std::size_t x, std::size_t y) {
+        this->pixels[this->width * y + x] = c;
+    }
+    [[nodiscard]] color get_pixel(std::size_t x, std::size_t y) const {
+        return this->pixels[this->width * y + x];
+    }
+    [[nodiscard]] color& operator()(std::size_t x, std::size_t y) {
+        return this->pixels[this->width * y + x];
+    }
+
+    [[nodiscard]] bitmap_view view() {
+        return {this->pixels.get(), this->width, this->height, this->width};
+    }
+    [[nodiscard]] const_bitmap_view view() const {
+        return {this->pixels.get(), this->width, this->height, this->width};
     }
-    [[nodiscard]] color get_pixel(short width_, short height_) const {
-        return this->pixels[this->width * height_ + width_];
+    [[nodiscard]] bitmap_view view(std::size_t x, std::size_t y, std::size_t width_, std::size_t height_) {
+        return this->view().subview(x, y, width_, height_);
     }
-    [[nodiscard]] color& operator()(short width_, short height_) {
-        return this->pixels[this->width * height_ + width_];
+    [[nodiscard]] const_bitmap_view view(std::size_t x, std::size_t y, std::size_t width_, std::size_t height_) const {
+        return this->view().subview(x, y, width_, height_);
     }
 
-    [[nodiscard]] std::vector<unsigned char> get_raw_png() const;
-    bool save(std::string_view filepath) const; // NOLINT(modernize-use-nodiscard)
+    // 8 bit RGB copy of the pixels for display, only refreshed by update_rgb8(). Rows are padded to a multiple of 4 bytes,
+    // so toolkits can wrap it without copying, e.g. QImage(get_rgb8(), width, height, get_rgb8_stride(), QImage::Format_RGB888).
+    // Only bitmaps that are displayed pay for it, it stays null until allocate_rgb8() or the first update_rgb8().
+    [[nodiscard]] const unsigned char* get_rgb8() const {
+        return this->rgb8.get();
+    }
+    [[nodiscard]] std::size_t get_rgb8_stride() const {
+        return get_rgb8_stride(this->width);
+    }
+    // Creates the 8 bit copy, all black, unless it already exists
+    void allocate_rgb8() {
+        if (!this->rgb8) {
+            this->rgb8 = std::make_unique<unsigned char[]>(get_rgb8_stride(this->width) * this->height);
+        }
+    }
+    // Converts a rectangle of pixels into the 8 bit copy, allocating it on first use.
+    // Once it is allocated, rectangles that don't overlap can be updated from different threads.
+    void update_rgb8(std::size_t x, std::size_t y, std::size_t width_, std::size_t height_);
+    void update_rgb8() {
+        this->update_rgb8(0, 0, this->width, this->height);
+    }
+
+    // Both compress strips of rows in parallel, level trades speed for size like zlib's
+    [[nodiscard]] std::vector<unsigned char> get_raw_png(int level = deflate_encoder::DEFAULT_LEVEL) const;
+    bool save(std::string_view filepath, int level = deflate_encoder::DEFAULT_LEVEL) const; // NOLINT(modernize-use-nodiscard)
 
 private:
-    short width;
-    short height;
+    [[nodiscard]] static std::size_t get_rgb8_stride(std::size_t width_) {
+        return (width_ * 3 + 3) & ~std::size_t{3};
+    }
+
+    std::size_t width = 0;
+    std::size_t height = 0;
     std::unique_ptr<color[]> pixels;
+    std::unique_ptr<unsigned char[]> rgb8;
 };
 
 } // namespace rt
@@ -0,0 +1,140 @@
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+using namespace rt;
+
+namespace {
+
+constexpr std::size_t SAH_BINS = 16;
+
+// Past this depth nodes are split at the median, which keeps the traversal stack from overflowing
+constexpr std::size_t MAX_SAH_DEPTH = 32;
+
+[[nodiscard]] float get_axis(vec v, int axis) {
+    return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+}
+
+} // namespace
+
+void bvh::build(std::span<const aabb> primitiveBounds) {
+    this->nodes.clear();
+    this->primitiveIndices.resize(primitiveBounds.size());
+    std::iota(this->primitiveIndices.begin(), this->primitiveIndices.end(), 0);
+    if (primitiveBounds.empty()) {
+        return;
+    }
+
+    std::vector<vec> centroids;
+    centroids.reserve(primitiveBounds.size());
+    for (const auto& bounds : primitiveBounds) {
+        centroids.push_back(bounds.centroid());
+    }
+    this->nodes.reserve(primitiveBounds.size() * 2 - 1);
+    this->build_node(primitiveBounds, centroids, 0, static_cast<std::uint32_t>(primitiveBounds.size()), 0);
+}
+
+std::uint32_t bvh::build_node(std::span<const aabb> primitiveBounds, std::span<const vec> centroids, std::uint32_t first, std::uint32_t count, std::size_t depth) {
+    const auto index = static_cast<std::uint32_t>(this->nodes.size());
+    this->nodes.emplace_back();
+
+    aabb bounds;
+    aabb centroidBounds;
+    for (std::uint32_t i = first; i < first + count; i++) {
+        bounds.expand(primitiveBounds[this->primitiveIndices[i]]);
+        centroidBounds.expand(centroids[this->primitiveIndices[i]]);
+    }
+    const auto make_leaf = [&] {
+        auto& node = this->nodes[index];
+        node = {{bounds.min.x, bounds.min.y, bounds.min.z}, first, {bounds.max.x, bounds.max.y, bounds.max.z}, static_cast<std::uint16_t>(count), 0};
+        return index;
+    };
+    if (count == 1) {
+        return make_leaf();
+    }
+
+    // Split along the axis the centroids are spread out the most
+    const auto extent = centroidBounds.extent();
+    int axis = 0;
+    if (extent.y > extent.x) {
+        axis = 1;
+    }
+    if (extent.z > get_axis(extent, axis)) {
+        axis = 2;
+    }
+    const float axisMin = get_axis(centroidBounds.min, axis);
+    const float axisExtent = get_axis(extent, axis);
+
+    const auto begin = this->primitiveIndices.begin() + first;
+    const auto end = begin + count;
+    auto middle = begin + count / 2;
+    if (axisExtent <= 0.f || depth >= MAX_SAH_DEPTH) {
+        // Every centroid is in the same spot, or the tree is getting too deep for the surface area heuristic to be worth it
+        if (count <= MAX_LEAF_SIZE) {
+            return make_leaf();
+        }
+        std::nth_element(begin, middle, end, [&](std::uint32_t a, std::uint32_t b) {
+            return get_axis(centroids[a], axis) < get_axis(centroids[b], axis);
+        });
+    } else {
+        const auto get_bin = [&](std::uint32_t primitive) {
+            const auto bin = static_cast<std::size_t>((get_axis(centroids[primitive], axis) - axisMin) / axisExtent * SAH_BINS);
+            return std::min(bin, SAH_BINS - 1);
+        };
+        std::array<aabb, SAH_BINS> binBounds;
+        std::array<std::uint32_t, SAH_BINS> binCounts {};
+        for (auto it = begin; it != end; ++it) {
+            const auto bin = get_bin(*it);
+            binBounds[bin].expand(primitiveBounds[*it]);
+            binCounts[bin]++;
+        }
+
+        // Sweep from the right to get the cost of everything past each split plane, then from the left to finish it
+        std::array<float, SAH_BINS - 1> rightCosts {};
+        aabb rightBounds;
+        std::uint32_t rightCount = 0;
+        for (std::size_t i = SAH_BINS - 1; i > 0; i--) {
+            rightBounds.expand(binBounds[i]);
+            rightCount += binCounts[i];
+            rightCosts[i - 1] = rightBounds.surface_area() * static_cast<float>(rightCount);
+        }
+        aabb leftBounds;
+        std::uint32_t leftCount = 0;
+        float bestCost = std::numeric_limits<float>::infinity();
+        std::size_t bestSplit = 0;
+        for (std::size_t i = 0; i < SAH_BINS - 1; i++) {
+            leftBounds.expand(binBounds[i]);
+            leftCount += binCounts[i];
+            if (leftCount == 0 || leftCount == count) {
+                continue;
+            }
+            const float cost = leftBounds.surface_area() * static_cast<float>(leftCount) + rightCosts[i];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        // Traversing a node costs about as much as intersecting one primitive
+        const float leafCost = static_cast<float>(count);
+        const float area = bounds.surface_area();
+        const float splitCost = area > 0.f ? 1.f + bestCost / area : 1.f;
+        if (count <= MAX_LEAF_SIZE && leafCost <= splitCost) {
+            return make_leaf();
+        }
+        middle = std::partition(begin, end, [&](std::uint32_t primitive) {
+            return get_bin(primitive) <= bestSplit;
+        });
+        if (middle == begin || middle == end) {
+            middle = begin + count / 2;
+        }
+    }
+
+    const auto leftCount = static_cast<std::uint32_t>(middle - begin);
+    this->build_node(primitiveBounds, centroids, first, leftCount, depth + 1);
+    const auto right = this->build_node(primitiveBounds, centroids, first + leftCount, count - leftCount, depth + 1);
+    this->nodes[index] = {{bounds.min.x, bounds.min.y, bounds.min.z}, right, {bounds.max.x, bounds.max.y, bounds.max.z}, 0, static_cast<std::uint16_t>(axis)};
+    return index;
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "aabb.hpp"
+#include "ray_packet.hpp"
+#include "simd.hpp"
+
+namespace rt {
+
+// Half a cache line, children and leaves are found through offsets into the flat node array
+struct bvh_node {
+    float boundsMin[3];
+    // Index of the first primitive for leaves, of the second child for inner nodes (the first child directly follows its parent)
+    std::uint32_t offset;
+    float boundsMax[3];
+    // Number of primitives, 0 for inner nodes
+    std::uint16_t count;
+    // Split axis of inner nodes
+    std::uint16_t axis;
+
+    [[nodiscard]] constexpr bool is_leaf() const {
+        return this->count > 0;
+    }
+};
+
+// Bounding volume hierarchy built with the surface area heuristic
+class bvh {
+public:
+    // Leaves are forced to split above this many primitives
+    static constexpr std::size_t MAX_LEAF_SIZE = 8;
+
+    bvh() = default;
+    explicit bvh(std::span<const aabb> primitiveBounds) {
+        this->build(primitiveBounds);
+    }
+
+    void build(std::span<const aabb> primitiveBounds);
+
+    [[nodiscard]] bool empty() const {
+        return this->nodes.empty();
+    }
+    [[nodiscard]] const std::vector<bvh_node>& get_nodes() const {
+        return this->nodes;
+    }
+    // Primitive indices in the order the leaves reference them
+    [[nodiscard]] const std::vector<std::uint32_t>& get_primitive_indices() const {
+        return this->primitiveIndices;
+    }
+
+    // Visits leaves near to far, calling intersect(first, count, maxDistance) with a range of get_primitive_indices().
+    // intersect lowers maxDistance when it finds a hit, which culls every node further away than it.
+    template<typename F>
+    void traverse(ray r, float maxDistance, F&& intersect) const {
+        if (this->nodes.empty()) {
+            return;
+        }
+        const float origin[3] {r.origin.x, r.origin.y, r.origin.z};
+        const float inverseDirection[3] {1.f / r.direction.x, 1.f / r.direction.y, 1.f / r.direction.z};
+
+        std::uint32_t stack[64];
+        std::size_t stackSize = 0;
+        std::uint32_t current = 0;
+        while (true) {
+            const auto& node = this->nodes[current];
+            if (bvh::intersects(node, origin, inverseDirection, maxDistance)) {
+                if (node.is_leaf()) {
+                    intersect(static_cast<std::size_t>(node.offset), static_cast<std::size_t>(node.count), maxDistance);
+                } else if (inverseDirection[node.axis] < 0) {
+                    stack[stackSize++] = current + 1;
+                    current = node.offset;
+                    continue;
+                } else {
+                    stack[stackSize++] = node.offset;
+                    current = current + 1;
+                    continue;
+                }
+            }
+            if (stackSize == 0) {
+                break;
+            }
+            current = stack[--stackSize];
+        }
+    }
+
+    // Same as traverse(), but stops as soon as intersects(first, count) returns true
+    template<typename F>
+    [[nodiscard]] bool traverse_any(ray r, float maxDistance, F&& intersects) const {
+        bool hit = false;
+        this->traverse(r, maxDistance, [&](std::size_t first, std::size_t count, float& maxDistance_) {
+            if (intersects(first, count)) {
+                hit = true;
+                // Nothing else can be closer than a negative distance, so this empties the traversal
+                maxDistance_ = -std::numeric_limits<float>::infinity();
+            }
+        });
+        return hit;
+    }
+
+    // Packet version of traverse(), calling intersect(first, count, laneMask, maxDistances) with the lanes that reach each leaf.
+    // Subtrees are skipped as soon as every lane misses them.
+    template<typename F>
+    void traverse(const ray_packet& packet, float (&maxDistances)[ray_packet::SIZE], F&& intersect) const {
+        if (this->nodes.empty() || packet.mask == 0) {
+            return;
+        }
+        float inverseDirection[3][ray_packet::SIZE];
+        for (int i = 0; i < 3; i++) {
+            for (std::size_t lane = 0; lane < ray_packet::SIZE; lane++) {
+                inverseDirection[i][lane] = 1.f / packet.direction[i][lane];
+            }
+        }
+        // Children are ordered by the first ray, the rest of a coherent packet mostly agrees with it
+        const auto lead = static_cast<std::size_t>(std::countr_zero(packet.mask));
+
+        struct stack_entry {
+            std::uint32_t node;
+            std::uint32_t mask;
+        };
+        stack_entry stack[64];
+        std::size_t stackSize = 0;
+        std::uint32_t current = 0;
+        std::uint32_t mask = packet.mask;
+        while (true) {
+            const auto& node = this->nodes[current];
+            mask = bvh::intersects(node, packet.origin, inverseDirection, maxDistances, mask);
+            if (mask != 0) {
+                if (node.is_leaf()) {
+                    intersect(static_cast<std::size_t>(node.offset), static_cast<std::size_t>(node.count), mask, maxDistances);
+                } else if (inverseDirection[node.axis][lead] < 0) {
+                    stack[stackSize++] = {current + 1, mask};
+                    current = node.offset;
+                    continue;
+                } else {
+                    stack[stackSize++] = {node.offset, mask};
+                    current = current + 1;
+                    continue;
+                }
+            }
+            if (stackSize == 0) {
+                break;
+            }
+            stackSize--;
+            current = stack[stackSize].node;
+            mask = stack[stackSize].mask;
+        }
+    }
+
+private:
+    [[nodiscard]] static bool intersects(const bvh_node& node, const float origin[3], const float inverseDirection[3], float maxDistance) {
+        float entry = 0.f;
+        float exit = maxDistance;
+        for (int i = 0; i < 3; i++) {
+            const float t1 = (node.boundsMin[i] - origin[i]) * inverseDirection[i];
+            const float t2 = (node.boundsMax[i] - origin[i]) * inverseDirection[i];
+            // A ray lying in one of the slab's planes gets 0 * inf = NaN there, that slab doesn't limit it
+            const bool inPlane = std::isunordered(t1, t2);
+            entry = inPlane ? entry : std::max(entry, std::min(t1, t2));
+            exit = inPlane ? exit : std::min(exit, std::max(t1, t2));
+        }
+        return entry <= exit;
+    }
+    // Slab test for every lane in mask, returns the lanes that hit
+    [[nodiscard]] static std::uint32_t intersects(const bvh_node& node, const float (&origin)[3][ray_packet::SIZE], const float (&inverseDirection)[3][ray_packet::SIZE], const float (&maxDistances)[ray_packet::SIZE], std::uint32_t mask) {
+#ifdef RT_SIMD_AVX2
+        __m256 entry = _mm256_setzero_ps();
+        __m256 exit = _mm256_loadu_ps(maxDistances);
+        for (int i = 0; i < 3; i++) {
+            const __m256 o = _mm256_loadu_ps(origin[i]);
+            const __m256 inverse = _mm256_loadu_ps(inverseDirection[i]);
+            const __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.boundsMin[i]), o), inverse);
+            const __m256 t2 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.boundsMax[i]), o), inverse);
+            // min and max return their second argument if either is NaN, which would be the other plane's infinity.
+            // Lanes lying in one of the slab's planes keep their entry and exit instead, like the scalar test.
+            const __m256 inPlane = _mm256_cmp_ps(t1, t2, _CMP_UNORD_Q);
+            entry = _mm256_blendv_ps(_mm256_max_ps(_mm256_min_ps(t1, t2), entry), entry, inPlane);
+            exit = _mm256_blendv_ps(_mm256_min_ps(_mm256_max_ps(t1, t2), exit), exit, inPlane);
+        }
+        return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(entry, exit, _CMP_LE_OQ))) & mask;
+#else
+        std::uint32_t hits = 0;
+        for (std::size_t lane = 0; lane < ray_packet::SIZE; lane++) {
+            float entry = 0.f;
+            float exit = maxDistances[lane];
+            for (int i = 0; i < 3; i++) {
+                const float t1 = (node.boundsMin[i] - origin[i][lane]) * inverseDirection[i][lane];
+                const float t2 = (node.boundsMax[i] - origin[i][lane]) * inverseDirection[i][lane];
+                // Selects rather than a branch, so the lanes still vectorize
+                const bool inPlane = std::isunordered(t1, t2);
+                entry = inPlane ? entry : std::max(entry, std::min(t1, t2));
+                exit = inPlane ? exit : std::min(exit, std::max(t1, t2));
+            }
+            hits |= static_cast<std::uint32_t>(entry <= exit) << lane;
+        }
+        return hits & mask;
+#endif
+    }
+
+    std::uint32_t build_node(std::span<const aabb> primitiveBounds, std::span<const vec> centroids, std::uint32_t first, std::uint32_t count, std::size_t depth);
+
+    std::vector<bvh_node> nodes;
+    std::vector<std::uint32_t> primitiveIndices;
+};
+
+} // namespace rt
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include "ray.hpp"
+
+namespace rt {
+
+// Pinhole camera with everything per pixel worked out up front, rays are generated by stepping from pixel to pixel.
+// Pixels are one unit apart on an image plane placed so the image height covers the vertical field of view.
+class camera {
+public:
+    // forward and up should be unit length and perpendicular, fov is vertical and in radians
+    camera(vec origin_, vec forward_, vec up_, float fov_, std::size_t width_, std::size_t height_)
+            : origin(origin_)
+            , forward(forward_)
+            , up(up_)
+            , fov(fov_) {
+        this->set_resolution(width_, height_);
+    }
+
+    void set_resolution(std::size_t width_, std::size_t height_) {
+        this->width = width_;
+        this->height = height_;
+        this->recalculate();
+    }
+    [[nodiscard]] std::size_t get_width() const {
+        return this->width;
+    }
+    [[nodiscard]] std::size_t get_height() const {
+        return this->height;
+    }
+    [[nodiscard]] vec get_origin() const {
+        return this->origin;
+    }
+    [[nodiscard]] vec get_forward() const {
+        return this->forward;
+    }
+    [[nodiscard]] vec get_up() const {
+        return this->up;
+    }
+    [[nodiscard]] float get_fov() const {
+        return this->fov;
+    }
+
+    // Unnormalized direction through the center of the top left pixel
+    [[nodiscard]] vec get_first_direction() const {
+        return this->firstDirection;
+    }
+    // Added to a direction to move one pixel right
+    [[nodiscard]] vec get_column_step() const {
+        return this->columnStep;
+    }
+    // Added to a direction to move one pixel down
+    [[nodiscard]] vec get_row_step() const {
+        return this->rowStep;
+    }
+
+    // Unnormalized direction through the center of pixel (x, y)
+    [[nodiscard]] vec get_direction(float x, float y) const {
+        return this->firstDirection + this->columnStep * x + this->rowStep * y;
+    }
+    [[nodiscard]] ray get_ray(float x, float y) const {
+        return {this->origin, this->get_direction(x, y).normalize()};
+    }
+
+private:
+    // https://stackoverflow.com/questions/5944109/raytracer-computing-eye-rays
+    void recalculate() {
+        const float distance = (static_cast<float>(this->height) / 2) / std::tan(this->fov / 2);
+        this->columnStep = this->forward.cross(this->up);
+        this->rowStep = -this->up;
+        // Pixel centers sit half a pixel in from the edges, which keeps odd sizes centered as well
+        this->firstDirection = this->forward * distance +
+                               this->columnStep * (0.5f - static_cast<float>(this->width) / 2) +
+                               this->rowStep * (0.5f - static_cast<float>(this->height) / 2);
+    }
+
+    vec origin;
+    vec forward;
+    vec up;
+    float fov;
+    std::size_t width = 0;
+    std::size_t height = 0;
+    vec firstDirection;
+    vec columnStep;
+    vec rowStep;
+};
+
+} // namespace rt
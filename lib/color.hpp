@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <span>
 #include <type_traits>
 
 #include "math.hpp"
@@ -45,4 +47,17 @@ struct color {
     }
 };
 
+// Clamps to [0, 1] and packs as 8 bit RGB, shared by display and export so what is on screen is what gets saved
+constexpr void to_rgb8(std::span<const color> in, unsigned char* out) {
+    const auto convert = [](float value) {
+        // Written so NaN ends up as 0
+        return static_cast<unsigned char>(value > 0.f ? (value < 1.f ? 255 * value : 255.f) : 0.f);
+    };
+    for (std::size_t i = 0; i < in.size(); i++) {
+        out[i * 3 + 0] = convert(in[i].r);
+        out[i * 3 + 1] = convert(in[i].g);
+        out[i * 3 + 2] = convert(in[i].b);
+    }
+}
+
 } // namespace rt
@@ -0,0 +1,600 @@
+#include "deflate.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <numeric>
+
+using namespace rt;
+
+namespace {
+
+constexpr std::size_t WINDOW_SIZE = 32768;
+constexpr std::size_t MIN_MATCH = 3;
+constexpr std::size_t MAX_MATCH = 258;
+constexpr unsigned int HASH_BITS = 15;
+// Blocks end after this many symbols or input bytes, whichever comes first, so the code can adapt to the data
+constexpr std::size_t MAX_BLOCK_SYMBOLS = 16384;
+constexpr std::size_t MAX_BLOCK_INPUT = 1 << 18;
+// Input is only dropped in large steps, which keeps slide() rare
+constexpr std::size_t SLIDE_SIZE = 1 << 18;
+
+constexpr std::size_t LITERAL_CODES = 286;
+constexpr std::size_t DISTANCE_CODES = 30;
+constexpr std::size_t CODE_LENGTH_CODES = 19;
+constexpr std::uint16_t END_OF_BLOCK = 256;
+
+constexpr std::array<std::uint16_t, 29> LENGTH_BASE {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::array<std::uint8_t, 29> LENGTH_EXTRA {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr std::array<std::uint16_t, 30> DISTANCE_BASE {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr std::array<std::uint8_t, 30> DISTANCE_EXTRA {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// Order the code length code lengths are sent in, the rarely used ones last so they can be left out
+constexpr std::array<std::uint8_t, CODE_LENGTH_CODES> CODE_LENGTH_ORDER {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+constexpr auto LENGTH_CODES = [] {
+    std::array<std::uint8_t, MAX_MATCH + 1> codes {};
+    for (std::size_t code = 0; code < LENGTH_BASE.size() - 1; code++) {
+        for (std::size_t length = LENGTH_BASE[code]; length < LENGTH_BASE[code] + (std::size_t{1} << LENGTH_EXTRA[code]) && length <= MAX_MATCH; length++) {
+            codes[length] = static_cast<std::uint8_t>(code);
+        }
+    }
+    codes[MAX_MATCH] = static_cast<std::uint8_t>(LENGTH_BASE.size() - 1);
+    return codes;
+}();
+
+[[nodiscard]] std::size_t get_distance_code(std::size_t distance) {
+    const auto d = distance - 1;
+    if (d < 4) {
+        return d;
+    }
+    // Two codes per power of two, told apart by the bit below the highest one
+    const auto log = static_cast<std::size_t>(std::bit_width(d)) - 1;
+    return 2 * log + ((d >> (log - 1)) & 1);
+}
+
+struct level_parameters {
+    std::size_t maxChain;
+    std::size_t niceLength;
+    bool lazy;
+};
+
+constexpr std::array<level_parameters, 10> LEVELS {{
+    {0, 0, false},
+    {4, 8, false},
+    {8, 16, false},
+    {16, 32, false},
+    {16, 32, true},
+    {32, 64, true},
+    {128, 128, true},
+    {256, MAX_MATCH, true},
+    {1024, MAX_MATCH, true},
+    {4096, MAX_MATCH, true},
+}};
+
+// Huffman code lengths no longer than maxLength for the given frequencies.
+// Codes are always complete, a lone symbol gets a partner so decoders never see a one symbol code.
+void build_lengths(std::span<const std::uint32_t> frequencies, unsigned int maxLength, std::span<std::uint8_t> lengths) {
+    std::ranges::fill(lengths, 0);
+    std::vector<std::uint32_t> used;
+    for (std::uint32_t i = 0; i < frequencies.size(); i++) {
+        if (frequencies[i] > 0) {
+            used.push_back(i);
+        }
+    }
+    if (used.empty()) {
+        return;
+    }
+    if (used.size() == 1) {
+        lengths[used[0]] = 1;
+        lengths[used[0] == 0 ? 1 : 0] = 1;
+        return;
+    }
+    std::ranges::stable_sort(used, [&](std::uint32_t a, std::uint32_t b) {
+        return frequencies[a] < frequencies[b];
+    });
+
+    // Two queue Huffman construction, leaves come sorted and merged nodes are created in increasing weight order
+    const auto n = used.size();
+    std::vector<std::uint64_t> weights(2 * n - 1);
+    std::vector<std::size_t> parents(2 * n - 1);
+    for (std::size_t i = 0; i < n; i++) {
+        weights[i] = frequencies[used[i]];
+    }
+    std::size_t nextLeaf = 0;
+    std::size_t nextMerged = n;
+    for (std::size_t node = n; node < 2 * n - 1; node++) {
+        const auto take = [&] {
+            if (nextLeaf < n && (nextMerged >= node || weights[nextLeaf] <= weights[nextMerged])) {
+                return nextLeaf++;
+            }
+            return nextMerged++;
+        };
+        const auto a = take();
+        const auto b = take();
+        weights[node] = weights[a] + weights[b];
+        parents[a] = node;
+        parents[b] = node;
+    }
+    // Parents always come after their children, so one backwards pass gives every depth
+    std::vector<std::size_t> depths(2 * n - 1);
+    for (std::size_t i = 2 * n - 2; i-- > 0;) {
+        depths[i] = depths[parents[i]] + 1;
+    }
+
+    std::array<std::size_t, 64> counts {};
+    for (std::size_t i = 0; i < n; i++) {
+        counts[std::min<std::size_t>(depths[i], maxLength)]++;
+    }
+    // Codes pushed down to maxLength oversubscribe the code space, lengthen shorter codes until it fits again
+    // https://github.com/richgel999/miniz/blob/master/miniz_tdef.c (tdefl_huffman_enforce_max_code_size)
+    std::size_t total = 0;
+    for (unsigned int length = 1; length <= maxLength; length++) {
+        total += counts[length] << (maxLength - length);
+    }
+    while (total != (std::size_t{1} << maxLength)) {
+        counts[maxLength]--;
+        for (auto length = maxLength - 1; length > 0; length--) {
+            if (counts[length] > 0) {
+                counts[length]--;
+                counts[length + 1] += 2;
+                break;
+            }
+        }
+        total--;
+    }
+
+    // Rarest symbols get the longest codes
+    std::size_t symbol = 0;
+    for (auto length = maxLength; length > 0; length--) {
+        for (std::size_t i = 0; i < counts[length]; i++) {
+            lengths[used[symbol++]] = static_cast<std::uint8_t>(length);
+        }
+    }
+}
+
+// Canonical codes for the lengths, bit reversed since deflate sends Huffman codes starting from the top bit
+void build_codes(std::span<const std::uint8_t> lengths, std::span<std::uint16_t> codes) {
+    std::array<std::uint16_t, 16> counts {};
+    for (const auto length : lengths) {
+        counts[length]++;
+    }
+    counts[0] = 0;
+    std::array<std::uint16_t, 16> nextCode {};
+    std::uint16_t code = 0;
+    for (std::size_t length = 1; length < 16; length++) {
+        code = static_cast<std::uint16_t>((code + counts[length - 1]) << 1);
+        nextCode[length] = code;
+    }
+    for (std::size_t i = 0; i < lengths.size(); i++) {
+        const auto length = lengths[i];
+        if (length == 0) {
+            continue;
+        }
+        auto value = nextCode[length]++;
+        std::uint16_t reversed = 0;
+        for (unsigned int bit = 0; bit < length; bit++) {
+            reversed = static_cast<std::uint16_t>((reversed << 1) | (value & 1));
+            value >>= 1;
+        }
+        codes[i] = reversed;
+    }
+}
+
+// The static code of RFC 1951 section 3.2.6
+constexpr auto FIXED_LITERAL_LENGTHS = [] {
+    std::array<std::uint8_t, 288> lengths {};
+    for (std::size_t i = 0; i < lengths.size(); i++) {
+        lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+    }
+    return lengths;
+}();
+constexpr auto FIXED_DISTANCE_LENGTHS = [] {
+    std::array<std::uint8_t, DISTANCE_CODES> lengths {};
+    lengths.fill(5);
+    return lengths;
+}();
+
+// Run length coded code lengths, as sent in the header of dynamic blocks
+struct code_length_symbol {
+    std::uint8_t symbol;
+    std::uint8_t extra;
+    std::uint8_t extraBits;
+};
+
+[[nodiscard]] std::vector<code_length_symbol> encode_code_lengths(std::span<const std::uint8_t> lengths) {
+    std::vector<code_length_symbol> out;
+    for (std::size_t i = 0; i < lengths.size();) {
+        const auto length = lengths[i];
+        std::size_t run = 1;
+        while (i + run < lengths.size() && lengths[i + run] == length) {
+            run++;
+        }
+        i += run;
+        if (length == 0) {
+            while (run >= 11) {
+                const auto count = std::min<std::size_t>(run, 138);
+                out.push_back({18, static_cast<std::uint8_t>(count - 11), 7});
+                run -= count;
+            }
+            if (run >= 3) {
+                out.push_back({17, static_cast<std::uint8_t>(run - 3), 3});
+                run = 0;
+            }
+        } else {
+            // Repeats refer back to a length that was sent, so the first one goes out on its own
+            out.push_back({length, 0, 0});
+            run--;
+            while (run >= 3) {
+                const auto count = std::min<std::size_t>(run, 6);
+                out.push_back({16, static_cast<std::uint8_t>(count - 3), 2});
+                run -= count;
+            }
+        }
+        for (; run > 0; run--) {
+            out.push_back({length, 0, 0});
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+std::uint32_t rt::adler32(std::span<const unsigned char> data, std::uint32_t adler) {
+    constexpr std::uint32_t MOD = 65521;
+    // Largest run that can't overflow the sums before they are reduced
+    constexpr std::size_t RUN = 5552;
+    std::uint32_t a = adler & 0xFFFF;
+    std::uint32_t b = adler >> 16;
+    for (std::size_t start = 0; start < data.size(); start += RUN) {
+        const auto end = std::min(start + RUN, data.size());
+        for (std::size_t i = start; i < end; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= MOD;
+        b %= MOD;
+    }
+    return (b << 16) | a;
+}
+
+std::uint32_t rt::adler32_combine(std::uint32_t first, std::uint32_t second, std::size_t secondLength) {
+    // Every byte of the second piece adds the first piece's sum once more to the second sum
+    // https://github.com/madler/zlib/blob/master/adler32.c (adler32_combine_)
+    constexpr std::uint32_t MOD = 65521;
+    const auto remainder = static_cast<std::uint32_t>(secondLength % MOD);
+    std::uint32_t a = first & 0xFFFF;
+    std::uint32_t b = static_cast<std::uint32_t>((static_cast<std::uint64_t>(remainder) * a) % MOD);
+    a += (second & 0xFFFF) + MOD - 1;
+    b += (first >> 16) + (second >> 16) + MOD - remainder;
+    a %= MOD;
+    b %= MOD;
+    return (b << 16) | a;
+}
+
+deflate_encoder::deflate_encoder(int level_)
+        : level(std::clamp(level_, 0, 9))
+        , maxChain(LEVELS[static_cast<std::size_t>(this->level)].maxChain)
+        , niceLength(LEVELS[static_cast<std::size_t>(this->level)].niceLength)
+        , lazy(LEVELS[static_cast<std::size_t>(this->level)].lazy)
+        , head(std::size_t{1} << HASH_BITS, -1)
+        , previous(WINDOW_SIZE, -1) {}
+
+void deflate_encoder::write(std::span<const unsigned char> data, std::vector<unsigned char>& out) {
+    // Taking the data a block at a time lets slide() keep up, so the input never grows past what positions can hold
+    while (!data.empty()) {
+        const auto piece = data.first(std::min(data.size(), MAX_BLOCK_INPUT));
+        data = data.subspan(piece.size());
+        this->slide();
+        this->input.insert(this->input.end(), piece.begin(), piece.end());
+        this->compress(false, out);
+    }
+}
+
+void deflate_encoder::set_dictionary(std::span<const unsigned char> dictionary) {
+    dictionary = dictionary.last(std::min(dictionary.size(), WINDOW_SIZE));
+    this->input.assign(dictionary.begin(), dictionary.end());
+    if (this->level > 0) {
+        for (std::size_t i = 0; i < this->input.size(); i++) {
+            this->insert(i);
+        }
+    }
+    this->position = this->input.size();
+    this->blockStart = this->position;
+}
+
+void deflate_encoder::flush(std::vector<unsigned char>& out) {
+    this->compress(true, out);
+    this->emit_block(false, out);
+    this->put_bits(0, 3, out);
+    this->align(out);
+    out.insert(out.end(), {0x00, 0x00, 0xFF, 0xFF});
+}
+
+void deflate_encoder::finish(std::vector<unsigned char>& out) {
+    this->compress(true, out);
+    this->emit_block(true, out);
+    this->align(out);
+}
+
+void deflate_encoder::compress(bool flush, std::vector<unsigned char>& out) {
+    // Without the end of the stream in sight, matches near the end of the input could still grow
+    const auto end = this->input.size();
+    const auto lookahead = flush ? 0 : MAX_MATCH + MIN_MATCH;
+    while (this->position + lookahead < end) {
+        if (this->level == 0) {
+            this->position = std::min(end, this->blockStart + MAX_BLOCK_INPUT);
+        } else {
+            const auto available = end - this->position;
+            match current = this->hasNextMatch ? this->nextMatch : this->find_match(this->position, available);
+            this->hasNextMatch = false;
+            this->insert(this->position);
+            if (this->lazy && current.length >= MIN_MATCH && current.length < this->niceLength && available > current.length) {
+                this->nextMatch = this->find_match(this->position + 1, available - 1);
+                if (this->nextMatch.length > current.length) {
+                    // A longer match starts at the next byte, which is worth sending this one as a literal
+                    this->hasNextMatch = true;
+                    current = {};
+                }
+            }
+            if (current.length >= MIN_MATCH) {
+                this->symbols.push_back({static_cast<std::uint16_t>(current.length), static_cast<std::uint16_t>(current.distance)});
+                for (std::size_t i = 1; i < current.length; i++) {
+                    this->insert(this->position + i);
+                }
+                this->position += current.length;
+            } else {
+                this->symbols.push_back({this->input[this->position], 0});
+                this->position++;
+            }
+        }
+        if (this->symbols.size() >= MAX_BLOCK_SYMBOLS || this->position - this->blockStart >= MAX_BLOCK_INPUT) {
+            this->emit_block(false, out);
+        }
+    }
+}
+
+deflate_encoder::match deflate_encoder::find_match(std::size_t at, std::size_t available) const {
+    if (available < MIN_MATCH) {
+        return {};
+    }
+    const auto maxLength = std::min(available, MAX_MATCH);
+    const auto limit = at > WINDOW_SIZE ? at - WINDOW_SIZE : 0;
+    const auto* current = this->input.data() + at;
+    match best;
+    std::size_t bestLength = MIN_MATCH - 1;
+    auto candidate = this->head[this->hash(at)];
+    for (auto chain = this->maxChain; candidate >= 0 && static_cast<std::size_t>(candidate) >= limit && chain > 0; chain--) {
+        const auto* other = this->input.data() + candidate;
+        // Checking the byte that would make the match longer first rejects most candidates straight away
+        if (other[bestLength] == current[bestLength] && other[0] == current[0] && other[1] == current[1]) {
+            std::size_t length = 2;
+            if constexpr (std::endian::native == std::endian::little) {
+                while (length + 8 <= maxLength) {
+                    std::uint64_t a;
+                    std::uint64_t b;
+                    std::memcpy(&a, current + length, 8);
+                    std::memcpy(&b, other + length, 8);
+                    if (a != b) {
+                        length += static_cast<std::size_t>(std::countr_zero(a ^ b)) / 8;
+                        break;
+                    }
+                    length += 8;
+                }
+            }
+            while (length < maxLength && current[length] == other[length]) {
+                length++;
+            }
+            length = std::min(length, maxLength);
+            if (length > bestLength) {
+                bestLength = length;
+                best = {length, at - static_cast<std::size_t>(candidate)};
+                if (length >= this->niceLength || length == maxLength) {
+                    break;
+                }
+            }
+        }
+        const auto next = this->previous[static_cast<std::size_t>(candidate) & (WINDOW_SIZE - 1)];
+        // The slot was reused by a newer position, everything older is gone
+        if (next >= candidate) {
+            break;
+        }
+        candidate = next;
+    }
+    return best;
+}
+
+std::size_t deflate_encoder::hash(std::size_t at) const {
+    const auto* bytes = this->input.data() + at;
+    const std::uint32_t value = bytes[0] | (static_cast<std::uint32_t>(bytes[1]) << 8) | (static_cast<std::uint32_t>(bytes[2]) << 16);
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void deflate_encoder::insert(std::size_t at) {
+    if (at + MIN_MATCH > this->input.size()) {
+        return;
+    }
+    const auto h = this->hash(at);
+    this->previous[at & (WINDOW_SIZE - 1)] = this->head[h];
+    this->head[h] = static_cast<std::int32_t>(at);
+}
+
+void deflate_encoder::emit_block(bool last, std::vector<unsigned char>& out) {
+    const std::span<const unsigned char> raw{this->input.data() + this->blockStart, this->position - this->blockStart};
+    const auto stored_bits = [&] {
+        const auto chunks = std::max<std::size_t>((raw.size() + 65534) / 65535, 1);
+        return (raw.size() + chunks * 5) * 8 + 7;
+    };
+    if (this->level == 0) {
+        this->emit_stored(raw, last, out);
+        return;
+    }
+
+    std::array<std::uint32_t, LITERAL_CODES> literalFrequencies {};
+    std::array<std::uint32_t, DISTANCE_CODES> distanceFrequencies {};
+    std::size_t extraBits = 0;
+    for (const auto s : this->symbols) {
+        if (s.distance == 0) {
+            literalFrequencies[s.value]++;
+        } else {
+            const auto lengthCode = LENGTH_CODES[s.value];
+            const auto distanceCode = get_distance_code(s.distance);
+            literalFrequencies[257 + lengthCode]++;
+            distanceFrequencies[distanceCode]++;
+            extraBits += LENGTH_EXTRA[lengthCode] + DISTANCE_EXTRA[distanceCode];
+        }
+    }
+    literalFrequencies[END_OF_BLOCK] = 1;
+
+    std::array<std::uint8_t, LITERAL_CODES> literalLengths {};
+    std::array<std::uint8_t, DISTANCE_CODES> distanceLengths {};
+    build_lengths(literalFrequencies, 15, literalLengths);
+    build_lengths(distanceFrequencies, 15, distanceLengths);
+    if (std::ranges::all_of(distanceLengths, [](std::uint8_t length) { return length == 0; })) {
+        // At least one distance code has to be sent even if no match uses it
+        distanceLengths[0] = 1;
+        distanceLengths[1] = 1;
+    }
+    std::size_t literalCount = LITERAL_CODES;
+    while (literalCount > 257 && literalLengths[literalCount - 1] == 0) {
+        literalCount--;
+    }
+    std::size_t distanceCount = DISTANCE_CODES;
+    while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0) {
+        distanceCount--;
+    }
+
+    std::vector<std::uint8_t> allLengths(literalLengths.begin(), literalLengths.begin() + static_cast<std::ptrdiff_t>(literalCount));
+    allLengths.insert(allLengths.end(), distanceLengths.begin(), distanceLengths.begin() + static_cast<std::ptrdiff_t>(distanceCount));
+    const auto codeLengthSymbols = encode_code_lengths(allLengths);
+    std::array<std::uint32_t, CODE_LENGTH_CODES> codeLengthFrequencies {};
+    for (const auto& s : codeLengthSymbols) {
+        codeLengthFrequencies[s.symbol]++;
+    }
+    std::array<std::uint8_t, CODE_LENGTH_CODES> codeLengthLengths {};
+    build_lengths(codeLengthFrequencies, 7, codeLengthLengths);
+    std::size_t codeLengthCount = CODE_LENGTH_CODES;
+    while (codeLengthCount > 4 && codeLengthLengths[CODE_LENGTH_ORDER[codeLengthCount - 1]] == 0) {
+        codeLengthCount--;
+    }
+
+    // Pick whichever of the three block types comes out smallest
+    std::size_t dynamicBits = 3 + 5 + 5 + 4 + 3 * codeLengthCount + extraBits;
+    for (const auto& s : codeLengthSymbols) {
+        dynamicBits += codeLengthLengths[s.symbol] + s.extraBits;
+    }
+    std::size_t fixedBits = 3 + extraBits;
+    for (std::size_t i = 0; i < LITERAL_CODES; i++) {
+        dynamicBits += static_cast<std::size_t>(literalFrequencies[i]) * literalLengths[i];
+        fixedBits += static_cast<std::size_t>(literalFrequencies[i]) * FIXED_LITERAL_LENGTHS[i];
+    }
+    for (std::size_t i = 0; i < DISTANCE_CODES; i++) {
+        dynamicBits += static_cast<std::size_t>(distanceFrequencies[i]) * distanceLengths[i];
+        fixedBits += static_cast<std::size_t>(distanceFrequencies[i]) * FIXED_DISTANCE_LENGTHS[i];
+    }
+    if (stored_bits() < std::min(dynamicBits, fixedBits)) {
+        this->emit_stored(raw, last, out);
+        return;
+    }
+
+    std::array<std::uint16_t, 288> literalCodes {};
+    std::array<std::uint16_t, DISTANCE_CODES> distanceCodes {};
+    std::span<const std::uint8_t> literalBits = literalLengths;
+    std::span<const std::uint8_t> distanceBits = distanceLengths;
+    if (fixedBits <= dynamicBits) {
+        this->put_bits(static_cast<std::uint32_t>(last) | (1u << 1), 3, out);
+        literalBits = FIXED_LITERAL_LENGTHS;
+        distanceBits = FIXED_DISTANCE_LENGTHS;
+    } else {
+        this->put_bits(static_cast<std::uint32_t>(last) | (2u << 1), 3, out);
+        this->put_bits(static_cast<std::uint32_t>(literalCount - 257), 5, out);
+        this->put_bits(static_cast<std::uint32_t>(distanceCount - 1), 5, out);
+        this->put_bits(static_cast<std::uint32_t>(codeLengthCount - 4), 4, out);
+        for (std::size_t i = 0; i < codeLengthCount; i++) {
+            this->put_bits(codeLengthLengths[CODE_LENGTH_ORDER[i]], 3, out);
+        }
+        std::array<std::uint16_t, CODE_LENGTH_CODES> codeLengthCodes {};
+        build_codes(codeLengthLengths, codeLengthCodes);
+        for (const auto& s : codeLengthSymbols) {
+            this->put_bits(codeLengthCodes[s.symbol], codeLengthLengths[s.symbol], out);
+            this->put_bits(s.extra, s.extraBits, out);
+        }
+    }
+    build_codes(literalBits, literalCodes);
+    build_codes(distanceBits, distanceCodes);
+
+    for (const auto s : this->symbols) {
+        if (s.distance == 0) {
+            this->put_bits(literalCodes[s.value], literalBits[s.value], out);
+            continue;
+        }
+        const auto lengthCode = LENGTH_CODES[s.value];
+        this->put_bits(literalCodes[257 + lengthCode], literalBits[257 + lengthCode], out);
+        this->put_bits(s.value - LENGTH_BASE[lengthCode], LENGTH_EXTRA[lengthCode], out);
+        const auto distanceCode = get_distance_code(s.distance);
+        this->put_bits(distanceCodes[distanceCode], distanceBits[distanceCode], out);
+        this->put_bits(s.distance - DISTANCE_BASE[distanceCode], DISTANCE_EXTRA[distanceCode], out);
+    }
+    this->put_bits(literalCodes[END_OF_BLOCK], literalBits[END_OF_BLOCK], out);
+
+    this->symbols.clear();
+    this->blockStart = this->position;
+}
+
+void deflate_encoder::emit_stored(std::span<const unsigned char> data, bool last, std::vector<unsigned char>& out) {
+    std::size_t offset = 0;
+    do {
+        const auto size = std::min<std::size_t>(data.size() - offset, 65535);
+        const bool lastChunk = offset + size == data.size();
+        this->put_bits(static_cast<std::uint32_t>(last && lastChunk), 3, out);
+        this->align(out);
+        out.push_back(static_cast<unsigned char>(size & 0xFF));
+        out.push_back(static_cast<unsigned char>(size >> 8));
+        out.push_back(static_cast<unsigned char>(~size & 0xFF));
+        out.push_back(static_cast<unsigned char>((~size >> 8) & 0xFF));
+        out.insert(out.end(), data.begin() + static_cast<std::ptrdiff_t>(offset), data.begin() + static_cast<std::ptrdiff_t>(offset + size));
+        offset += size;
+    } while (offset < data.size());
+
+    this->symbols.clear();
+    this->blockStart = this->position;
+}
+
+void deflate_encoder::slide() {
+    // Matches reach back a window from the parse position, stored blocks need everything since the block started
+    const auto keep = std::min(this->blockStart, this->position > WINDOW_SIZE ? this->position - WINDOW_SIZE : 0);
+    // Whole windows, so positions keep their slot in previous
+    const auto drop = keep / WINDOW_SIZE * WINDOW_SIZE;
+    if (drop < SLIDE_SIZE) {
+        return;
+    }
+    this->input.erase(this->input.begin(), this->input.begin() + static_cast<std::ptrdiff_t>(drop));
+    this->position -= drop;
+    this->blockStart -= drop;
+    const auto rebase = [drop](std::int32_t& entry) {
+        entry = entry >= static_cast<std::int32_t>(drop) ? entry - static_cast<std::int32_t>(drop) : -1;
+    };
+    std::ranges::for_each(this->head, rebase);
+    std::ranges::for_each(this->previous, rebase);
+}
+
+void deflate_encoder::put_bits(std::uint32_t bits, unsigned int count, std::vector<unsigned char>& out) {
+    this->bitBuffer |= static_cast<std::uint64_t>(bits) << this->bitCount;
+    this->bitCount += count;
+    if (this->bitCount >= 32) {
+        for (int i = 0; i < 4; i++) {
+            out.push_back(static_cast<unsigned char>(this->bitBuffer & 0xFF));
+            this->bitBuffer >>= 8;
+        }
+        this->bitCount -= 32;
+    }
+}
+
+void deflate_encoder::align(std::vector<unsigned char>& out) {
+    while (this->bitCount > 0) {
+        out.push_back(static_cast<unsigned char>(this->bitBuffer & 0xFF));
+        this->bitBuffer >>= 8;
+        this->bitCount = this->bitCount > 8 ? this->bitCount - 8 : 0;
+    }
+    this->bitBuffer = 0;
+}
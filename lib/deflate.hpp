@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace rt {
+
+// Running Adler-32 checksum as used by zlib streams, start with 1
+[[nodiscard]] std::uint32_t adler32(std::span<const unsigned char> data, std::uint32_t adler = 1);
+// Checksum of two pieces from each one's own checksum, secondLength is the size of the second piece
+[[nodiscard]] std::uint32_t adler32_combine(std::uint32_t first, std::uint32_t second, std::size_t secondLength);
+
+// Streaming raw deflate (RFC 1951) compressor, LZ77 over hash chains with a Huffman code picked per block.
+// Input can be fed in pieces of any size, compressed bytes are appended to out as blocks complete.
+class deflate_encoder {
+public:
+    // 0 only stores, 1 is fastest and 9 compresses best
+    static constexpr int DEFAULT_LEVEL = 6;
+
+    explicit deflate_encoder(int level = DEFAULT_LEVEL);
+
+    // Lets matches refer to the data this stream continues from, only the last 32 KB matter. Call it before any write().
+    void set_dictionary(std::span<const unsigned char> dictionary);
+
+    void write(std::span<const unsigned char> data, std::vector<unsigned char>& out);
+    // Compresses everything written so far and pads to a whole byte with an empty stored block, without ending the stream.
+    // Output of an encoder that is flushed can be followed by another encoder's, which is how streams are split across threads.
+    void flush(std::vector<unsigned char>& out);
+    // Compresses whatever is left and ends the stream, the encoder can't be written to afterwards
+    void finish(std::vector<unsigned char>& out);
+
+private:
+    struct symbol {
+        // Literal byte, or match length when distance isn't 0
+        std::uint16_t value;
+        std::uint16_t distance;
+    };
+    struct match {
+        std::size_t length = 0;
+        std::size_t distance = 0;
+    };
+
+    // Parses the input into symbols, leaving enough unparsed for the longest match unless the stream is ending
+    void compress(bool flush, std::vector<unsigned char>& out);
+    [[nodiscard]] match find_match(std::size_t at, std::size_t available) const;
+    [[nodiscard]] std::size_t hash(std::size_t at) const;
+    void insert(std::size_t at);
+    void emit_block(bool last, std::vector<unsigned char>& out);
+    void emit_stored(std::span<const unsigned char> data, bool last, std::vector<unsigned char>& out);
+    // Drops input that no block or match can refer to anymore
+    void slide();
+
+    void put_bits(std::uint32_t bits, unsigned int count, std::vector<unsigned char>& out);
+    void align(std::vector<unsigned char>& out);
+
+    int level;
+    std::size_t maxChain;
+    std::size_t niceLength;
+    bool lazy;
+
+    // Input not yet dropped by slide(), the window for matches followed by whatever hasn't been parsed
+    std::vector<unsigned char> input;
+    std::size_t position = 0;
+    std::size_t blockStart = 0;
+    std::vector<symbol> symbols;
+    // Match at position found while deciding whether to take the previous one
+    match nextMatch;
+    bool hasNextMatch = false;
+    // Most recent position for every hash of three bytes, and the one before it with the same hash, -1 for none.
+    // Positions are into input, which write() keeps to a few blocks however much it is given at once.
+    std::vector<std::int32_t> head;
+    std::vector<std::int32_t> previous;
+
+    std::uint64_t bitBuffer = 0;
+    unsigned int bitCount = 0;
+};
+
+} // namespace rt
@@ -0,0 +1,203 @@
+#include "mapped_file.hpp"
+
+#include <cerrno>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <winioctl.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+using namespace rt;
+
+namespace {
+
+bool get_directory(std::filesystem::path& directory, std::string& error) {
+    if (!directory.empty()) {
+        return true;
+    }
+    std::error_code code;
+    directory = std::filesystem::temp_directory_path(code);
+    if (code) {
+        error = "could not find the temporary directory: " + code.message();
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+mapped_file::mapped_file(mapped_file&& other) noexcept {
+    *this = std::move(other);
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    this->close();
+    this->mapping = std::exchange(other.mapping, nullptr);
+    this->mappingSize = std::exchange(other.mappingSize, 0);
+#ifdef _WIN32
+    this->file = std::exchange(other.file, nullptr);
+    this->fileMapping = std::exchange(other.fileMapping, nullptr);
+#else
+    this->file = std::exchange(other.file, -1);
+#endif
+    return *this;
+}
+
+mapped_file::~mapped_file() {
+    this->close();
+}
+
+#ifdef _WIN32
+
+bool mapped_file::create(std::size_t size, std::string& error, std::filesystem::path directory) {
+    this->close();
+    const auto fail = [&](std::string_view what) {
+        error = std::string{what} + ": " + std::system_category().message(static_cast<int>(GetLastError()));
+        this->close();
+        return false;
+    };
+    if (!get_directory(directory, error)) {
+        return false;
+    }
+
+    wchar_t name[MAX_PATH];
+    if (!GetTempFileNameW(directory.c_str(), L"rt", 0, name)) {
+        return fail("could not create scratch file");
+    }
+    this->file = CreateFileW(name, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (this->file == INVALID_HANDLE_VALUE) {
+        this->file = nullptr;
+        DeleteFileW(name);
+        return fail("could not open scratch file");
+    }
+    // Without this NTFS zero fills everything before the furthest page written
+    DWORD returned;
+    DeviceIoControl(this->file, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &returned, nullptr);
+    if (size == 0) {
+        return true;
+    }
+
+    const auto high = static_cast<DWORD>(static_cast<unsigned long long>(size) >> 32);
+    const auto low = static_cast<DWORD>(size & 0xFFFFFFFF);
+    this->fileMapping = CreateFileMappingW(this->file, nullptr, PAGE_READWRITE, high, low, nullptr);
+    if (!this->fileMapping) {
+        return fail("could not resize scratch file");
+    }
+    this->mapping = static_cast<unsigned char*>(MapViewOfFile(this->fileMapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    if (!this->mapping) {
+        return fail("could not map scratch file");
+    }
+    this->mappingSize = size;
+    return true;
+}
+
+void mapped_file::close() {
+    if (this->mapping) {
+        UnmapViewOfFile(this->mapping);
+    }
+    if (this->fileMapping) {
+        CloseHandle(this->fileMapping);
+    }
+    if (this->file) {
+        CloseHandle(this->file);
+    }
+    this->mapping = nullptr;
+    this->mappingSize = 0;
+    this->fileMapping = nullptr;
+    this->file = nullptr;
+}
+
+void mapped_file::release(std::size_t offset, std::size_t length) const {
+    const auto pageSize = get_page_size();
+    const auto first = (offset + pageSize - 1) / pageSize * pageSize;
+    const auto last = (offset + length) / pageSize * pageSize;
+    if (first < last) {
+        // Unlocking pages that were never locked takes them out of the working set
+        VirtualUnlock(this->mapping + first, last - first);
+    }
+}
+
+std::size_t mapped_file::get_page_size() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+}
+
+#else
+
+bool mapped_file::create(std::size_t size, std::string& error, std::filesystem::path directory) {
+    this->close();
+    const auto fail = [&](std::string_view what) {
+        error = std::string{what} + ": " + std::generic_category().message(errno);
+        this->close();
+        return false;
+    };
+    if (!get_directory(directory, error)) {
+        return false;
+    }
+
+    const auto pattern = (directory / "raytracer-XXXXXX").string();
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+    this->file = mkstemp(name.data());
+    if (this->file < 0) {
+        return fail("could not create scratch file");
+    }
+    unlink(name.data());
+    if (size == 0) {
+        return true;
+    }
+
+    if (ftruncate(this->file, static_cast<off_t>(size)) != 0) {
+        return fail("could not resize scratch file");
+    }
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, this->file, 0);
+    if (address == MAP_FAILED) {
+        return fail("could not map scratch file");
+    }
+    this->mapping = static_cast<unsigned char*>(address);
+    this->mappingSize = size;
+    return true;
+}
+
+void mapped_file::close() {
+    if (this->mapping) {
+        munmap(this->mapping, this->mappingSize);
+    }
+    if (this->file >= 0) {
+        ::close(this->file);
+    }
+    this->mapping = nullptr;
+    this->mappingSize = 0;
+    this->file = -1;
+}
+
+void mapped_file::release(std::size_t offset, std::size_t length) const {
+    const auto pageSize = get_page_size();
+    const auto first = (offset + pageSize - 1) / pageSize * pageSize;
+    const auto last = (offset + length) / pageSize * pageSize;
+    if (first < last) {
+        // Shared file pages stay in the page cache until written back, so this only unmaps them from the process
+        madvise(this->mapping + first, last - first, MADV_DONTNEED);
+    }
+}
+
+std::size_t mapped_file::get_page_size() {
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+#endif
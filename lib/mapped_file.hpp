@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+namespace rt {
+
+// Anonymous scratch file mapped into memory, the operating system pages it in and out so it can be far larger than RAM.
+// The file is deleted as soon as it is created (or on close on Windows), so nothing is left behind after a crash.
+class mapped_file {
+public:
+    mapped_file() = default;
+    mapped_file(const mapped_file& other) = delete;
+    mapped_file& operator=(const mapped_file& other) = delete;
+    mapped_file(mapped_file&& other) noexcept;
+    mapped_file& operator=(mapped_file&& other) noexcept;
+    ~mapped_file();
+
+    // Maps size zeroed bytes backed by a new file in directory (the system's temporary directory if empty),
+    // returns false and describes the problem in error on failure.
+    // The file is sparse where the platform allows it, so disk space is only used once pages are written to.
+    bool create(std::size_t size, std::string& error, std::filesystem::path directory = {});
+    void close();
+
+    [[nodiscard]] unsigned char* data() const {
+        return this->mapping;
+    }
+    [[nodiscard]] std::size_t size() const {
+        return this->mappingSize;
+    }
+
+    // Lets the operating system drop a range from memory, it is written back first and read in again on the next access.
+    // The range is shrunk to whole pages.
+    void release(std::size_t offset, std::size_t length) const;
+
+    [[nodiscard]] static std::size_t get_page_size();
+
+private:
+    unsigned char* mapping = nullptr;
+    std::size_t mappingSize = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* fileMapping = nullptr;
+#else
+    int file = -1;
+#endif
+};
+
+} // namespace rt
@@ -2,8 +2,10 @@
 
 #include <array>
 #include <cmath>
+#include <type_traits>
 
 #include "math.hpp"
+#include "simd.hpp"
 #include "vec.hpp"
 
 namespace rt {
@@ -146,6 +148,11 @@ struct mat {
 
     [[nodiscard]] constexpr float determinant() const {
         static_assert(W == H);
+        if constexpr (W == 4) {
+            if (!std::is_constant_evaluated()) {
+                return this->determinant_closed_form();
+            }
+        }
         if constexpr (W == 1) {
             return this->get(0, 0);
         } else if constexpr (W == 2) {
@@ -164,6 +171,16 @@ struct mat {
     }
 
     [[nodiscard]] constexpr mat<W, H> inverse() const {
+        if constexpr (W == 4 && H == 4) {
+            if (!std::is_constant_evaluated()) {
+                return this->inverse_simd();
+            }
+        }
+        return this->inverse_cofactors();
+    }
+
+    // Generic inverse, transposes the cofactor matrix and divides by the determinant
+    [[nodiscard]] constexpr mat<W, H> inverse_cofactors() const {
         if (!this->invertible()) {
             if constexpr (W == H) {
                 return mat<W, H>::make_identity();
@@ -183,6 +200,142 @@ struct mat {
         return out;
     }
 
+    // Expands the 4x4 determinant over the 2x2 subdeterminants of the top and bottom row pairs
+    [[nodiscard]] constexpr float determinant_closed_form() const {
+        static_assert(W == 4 && H == 4);
+        const auto& m = this->values;
+        const float s0 = m[0] * m[5] - m[4] * m[1];
+        const float s1 = m[0] * m[6] - m[4] * m[2];
+        const float s2 = m[0] * m[7] - m[4] * m[3];
+        const float s3 = m[1] * m[6] - m[5] * m[2];
+        const float s4 = m[1] * m[7] - m[5] * m[3];
+        const float s5 = m[2] * m[7] - m[6] * m[3];
+        const float c5 = m[10] * m[15] - m[14] * m[11];
+        const float c4 = m[9] * m[15] - m[13] * m[11];
+        const float c3 = m[9] * m[14] - m[13] * m[10];
+        const float c2 = m[8] * m[15] - m[12] * m[11];
+        const float c1 = m[8] * m[14] - m[12] * m[10];
+        const float c0 = m[8] * m[13] - m[12] * m[9];
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+
+    // Same 2x2 subdeterminants as determinant_closed_form(), reused for every element of the adjugate
+    [[nodiscard]] constexpr mat<4, 4> inverse_closed_form() const {
+        static_assert(W == 4 && H == 4);
+        const auto& m = this->values;
+        const float s0 = m[0] * m[5] - m[4] * m[1];
+        const float s1 = m[0] * m[6] - m[4] * m[2];
+        const float s2 = m[0] * m[7] - m[4] * m[3];
+        const float s3 = m[1] * m[6] - m[5] * m[2];
+        const float s4 = m[1] * m[7] - m[5] * m[3];
+        const float s5 = m[2] * m[7] - m[6] * m[3];
+        const float c5 = m[10] * m[15] - m[14] * m[11];
+        const float c4 = m[9] * m[15] - m[13] * m[11];
+        const float c3 = m[9] * m[14] - m[13] * m[10];
+        const float c2 = m[8] * m[15] - m[12] * m[11];
+        const float c1 = m[8] * m[14] - m[12] * m[10];
+        const float c0 = m[8] * m[13] - m[12] * m[9];
+        const float determinant_ = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        if (determinant_ == 0.f) {
+            return mat<4, 4>::make_identity();
+        }
+        const float inv = 1.f / determinant_;
+        return mat<4, 4>{
+            ( m[5] * c5 - m[6] * c4 + m[7] * c3) * inv,
+            (-m[1] * c5 + m[2] * c4 - m[3] * c3) * inv,
+            ( m[13] * s5 - m[14] * s4 + m[15] * s3) * inv,
+            (-m[9] * s5 + m[10] * s4 - m[11] * s3) * inv,
+            (-m[4] * c5 + m[6] * c2 - m[7] * c1) * inv,
+            ( m[0] * c5 - m[2] * c2 + m[3] * c1) * inv,
+            (-m[12] * s5 + m[14] * s2 - m[15] * s1) * inv,
+            ( m[8] * s5 - m[10] * s2 + m[11] * s1) * inv,
+            ( m[4] * c4 - m[5] * c2 + m[7] * c0) * inv,
+            (-m[0] * c4 + m[1] * c2 - m[3] * c0) * inv,
+            ( m[12] * s4 - m[13] * s2 + m[15] * s0) * inv,
+            (-m[8] * s4 + m[9] * s2 - m[11] * s0) * inv,
+            (-m[4] * c3 + m[5] * c1 - m[6] * c0) * inv,
+            ( m[0] * c3 - m[1] * c1 + m[2] * c0) * inv,
+            (-m[12] * s3 + m[13] * s1 - m[14] * s0) * inv,
+            ( m[8] * s3 - m[9] * s1 + m[10] * s0) * inv
+        };
+    }
+
+    // Block matrix inverse over the four 2x2 quadrants, falls back to inverse_closed_form() without SSE
+    // https://lxjk.github.io/2017/09/03/Fast-4x4-Matrix-Inverse-with-SSE-SIMD-Explained.html
+    [[nodiscard]] mat<4, 4> inverse_simd() const {
+        static_assert(W == 4 && H == 4);
+#ifdef RT_SIMD_SSE
+        const __m128 row0 = _mm_loadu_ps(this->values + 0);
+        const __m128 row1 = _mm_loadu_ps(this->values + 4);
+        const __m128 row2 = _mm_loadu_ps(this->values + 8);
+        const __m128 row3 = _mm_loadu_ps(this->values + 12);
+
+        // 2x2 quadrants, each stored row major in one register
+        const __m128 a = _mm_movelh_ps(row0, row1);
+        const __m128 b = _mm_movehl_ps(row1, row0);
+        const __m128 c = _mm_movelh_ps(row2, row3);
+        const __m128 d = _mm_movehl_ps(row3, row2);
+
+        // (|A| |B| |C| |D|)
+        const __m128 detSub = _mm_sub_ps(
+                _mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(3, 1, 3, 1))),
+                _mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(2, 0, 2, 0))));
+        const __m128 detA = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 0, 0, 0));
+        const __m128 detB = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(1, 1, 1, 1));
+        const __m128 detC = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(2, 2, 2, 2));
+        const __m128 detD = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(3, 3, 3, 3));
+
+        // A * B
+        const auto mul2 = [](__m128 l, __m128 r) {
+            return _mm_add_ps(_mm_mul_ps(l, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 0, 3, 0))),
+                              _mm_mul_ps(_mm_shuffle_ps(l, l, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 2, 1, 2))));
+        };
+        // adj(A) * B
+        const auto adjMul2 = [](__m128 l, __m128 r) {
+            return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(l, l, _MM_SHUFFLE(0, 0, 3, 3)), r),
+                              _mm_mul_ps(_mm_shuffle_ps(l, l, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 0, 3, 2))));
+        };
+        // A * adj(B)
+        const auto mulAdj2 = [](__m128 l, __m128 r) {
+            return _mm_sub_ps(_mm_mul_ps(l, _mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 3, 0, 3))),
+                              _mm_mul_ps(_mm_shuffle_ps(l, l, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 2, 1, 2))));
+        };
+
+        const __m128 dAdjC = adjMul2(d, c);
+        const __m128 aAdjB = adjMul2(a, b);
+        __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mul2(b, dAdjC));
+        __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mul2(c, aAdjB));
+        __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mulAdj2(d, aAdjB));
+        __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mulAdj2(a, dAdjC));
+
+        // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+        __m128 trace = _mm_mul_ps(aAdjB, _mm_shuffle_ps(dAdjC, dAdjC, _MM_SHUFFLE(3, 1, 2, 0)));
+        trace = _mm_add_ps(trace, _mm_movehl_ps(trace, trace));
+        trace = _mm_add_ss(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(1, 1, 1, 1)));
+        __m128 detM = _mm_sub_ss(_mm_add_ss(_mm_mul_ss(detA, detD), _mm_mul_ss(detB, detC)), trace);
+        if (_mm_cvtss_f32(detM) == 0.f) {
+            return mat<4, 4>::make_identity();
+        }
+        detM = _mm_shuffle_ps(detM, detM, _MM_SHUFFLE(0, 0, 0, 0));
+
+        const __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), detM);
+        x = _mm_mul_ps(x, rDetM);
+        y = _mm_mul_ps(y, rDetM);
+        z = _mm_mul_ps(z, rDetM);
+        w = _mm_mul_ps(w, rDetM);
+
+        // adjugate of each quadrant, shuffled straight back into rows
+        mat<4, 4> out;
+        _mm_storeu_ps(out.values + 0, _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+        _mm_storeu_ps(out.values + 4, _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+        _mm_storeu_ps(out.values + 8, _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+        _mm_storeu_ps(out.values + 12, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+        return out;
+#else
+        return this->inverse_closed_form();
+#endif
+    }
+
     [[nodiscard]] constexpr int get_width() const {
         return W;
     }
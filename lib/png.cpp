@@ -0,0 +1,297 @@
+#include "png.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <streambuf>
+#include <utility>
+
+#include "tile.hpp"
+
+using namespace rt;
+
+namespace {
+
+// Compressed data is sent in chunks of this size, big enough that chunk headers don't matter
+constexpr std::size_t CHUNK_SIZE = 1 << 16;
+constexpr std::size_t BYTES_PER_PIXEL = 3;
+// Filtered data each parallel strip compresses, rounded to whole rows. Strips also filter up to 32 KB of rows before
+// them as their dictionary, so much smaller strips would spend a noticeable part of their time on that.
+constexpr std::size_t STRIP_SIZE = 1 << 18;
+constexpr std::size_t DICTIONARY_SIZE = 32768;
+
+constexpr auto CRC_TABLE = [] {
+    std::array<std::uint32_t, 256> table {};
+    for (std::uint32_t i = 0; i < table.size(); i++) {
+        std::uint32_t c = i;
+        for (int bit = 0; bit < 8; bit++) {
+            c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}();
+
+void put_u32(unsigned char* out, std::uint32_t value) {
+    out[0] = static_cast<unsigned char>(value >> 24);
+    out[1] = static_cast<unsigned char>(value >> 16);
+    out[2] = static_cast<unsigned char>(value >> 8);
+    out[3] = static_cast<unsigned char>(value);
+}
+
+[[nodiscard]] unsigned char paeth(int left, int up, int upLeft) {
+    const int estimate = left + up - upLeft;
+    const int distanceLeft = std::abs(estimate - left);
+    const int distanceUp = std::abs(estimate - up);
+    const int distanceUpLeft = std::abs(estimate - upLeft);
+    if (distanceLeft <= distanceUp && distanceLeft <= distanceUpLeft) {
+        return static_cast<unsigned char>(left);
+    }
+    return static_cast<unsigned char>(distanceUp <= distanceUpLeft ? up : upLeft);
+}
+
+// Filters an 8 bit RGB row with whichever predictor leaves the smallest residuals, the heuristic libpng uses.
+// filtered gets the filter type byte followed by the row, candidate is scratch space of the same size.
+void filter_row(std::span<const unsigned char> current, std::span<const unsigned char> previous, std::vector<unsigned char>& filtered, std::vector<unsigned char>& candidate) {
+    const auto size = current.size();
+    std::size_t bestScore = std::numeric_limits<std::size_t>::max();
+    for (unsigned char type = 0; type < 5; type++) {
+        candidate[0] = type;
+        std::size_t score = 0;
+        for (std::size_t i = 0; i < size; i++) {
+            const int value = current[i];
+            const int left = i >= BYTES_PER_PIXEL ? current[i - BYTES_PER_PIXEL] : 0;
+            const int up = previous[i];
+            const int upLeft = i >= BYTES_PER_PIXEL ? previous[i - BYTES_PER_PIXEL] : 0;
+            int prediction = 0;
+            switch (type) {
+                case 1: prediction = left; break;
+                case 2: prediction = up; break;
+                case 3: prediction = (left + up) / 2; break;
+                case 4: prediction = paeth(left, up, upLeft); break;
+                default: break;
+            }
+            const auto residual = static_cast<unsigned char>(value - prediction);
+            candidate[i + 1] = residual;
+            score += static_cast<std::size_t>(std::abs(static_cast<signed char>(residual)));
+        }
+        if (score < bestScore) {
+            bestScore = score;
+            std::swap(filtered, candidate);
+        }
+    }
+}
+
+void write_chunk(std::ostream& out, const char (&type)[5], std::span<const unsigned char> data) {
+    unsigned char header[8];
+    put_u32(header, static_cast<std::uint32_t>(data.size()));
+    std::copy(type, type + 4, header + 4);
+    unsigned char footer[4];
+    put_u32(footer, rt::crc32(data, rt::crc32({header + 4, 4})));
+
+    out.write(reinterpret_cast<const char*>(header), sizeof(header)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size())); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    out.write(reinterpret_cast<const char*>(footer), sizeof(footer)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+// Signature and IHDR
+void write_header(std::ostream& out, std::size_t width, std::size_t height) {
+    constexpr unsigned char SIGNATURE[] {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.write(reinterpret_cast<const char*>(SIGNATURE), sizeof(SIGNATURE)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+    unsigned char header[13] {};
+    put_u32(header, static_cast<std::uint32_t>(width));
+    put_u32(header + 4, static_cast<std::uint32_t>(height));
+    header[8] = 8; // bits per channel
+    header[9] = 2; // RGB
+    write_chunk(out, "IHDR", header);
+}
+
+// zlib header, deflate with a 32 KB window and the level hint the format asks for, checked to be a multiple of 31
+void put_zlib_header(int level, std::vector<unsigned char>& out) {
+    const int hint = level <= 1 ? 0 : level <= 5 ? 1 : level == 6 ? 2 : 3;
+    const auto flags = static_cast<unsigned char>(hint << 6);
+    out.push_back(0x78);
+    out.push_back(static_cast<unsigned char>(flags + 31 - (0x78 * 256 + flags) % 31));
+}
+
+void put_adler(std::uint32_t adler, std::vector<unsigned char>& out) {
+    unsigned char checksum[4];
+    put_u32(checksum, adler);
+    out.insert(out.end(), std::begin(checksum), std::end(checksum));
+}
+
+// Stream buffer that appends to a vector, so stream writers can fill memory without a copy at the end
+class vector_buffer : public std::streambuf {
+public:
+    explicit vector_buffer(std::vector<unsigned char>& out_) : out(out_) {}
+
+protected:
+    std::streamsize xsputn(const char* data, std::streamsize count) override {
+        this->out.insert(this->out.end(), data, data + count);
+        return count;
+    }
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            this->out.push_back(static_cast<unsigned char>(traits_type::to_char_type(c)));
+        }
+        return traits_type::not_eof(c);
+    }
+
+private:
+    std::vector<unsigned char>& out;
+};
+
+} // namespace
+
+std::uint32_t rt::crc32(std::span<const unsigned char> data, std::uint32_t crc) {
+    crc = ~crc;
+    for (const auto byte : data) {
+        crc = CRC_TABLE[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+png_writer::png_writer(std::ostream& out_, std::size_t width_, std::size_t height_, int level)
+        : out(out_)
+        , width(width_)
+        , height(height_)
+        , encoder(level)
+        , current(width_ * BYTES_PER_PIXEL)
+        , previous(width_ * BYTES_PER_PIXEL)
+        , filtered(width_ * BYTES_PER_PIXEL + 1)
+        , candidate(width_ * BYTES_PER_PIXEL + 1) {
+    write_header(this->out, this->width, this->height);
+    put_zlib_header(level, this->compressed);
+}
+
+void png_writer::write_row(std::span<const color> row) {
+    to_rgb8(row.first(this->width), this->current.data());
+    filter_row(this->current, this->previous, this->filtered, this->candidate);
+    this->encoder.write(this->filtered, this->compressed);
+    this->adler = adler32(this->filtered, this->adler);
+    std::swap(this->current, this->previous);
+    this->rowsWritten++;
+    this->flush_data(false);
+}
+
+bool png_writer::finish() {
+    this->encoder.finish(this->compressed);
+    put_adler(this->adler, this->compressed);
+    this->flush_data(true);
+    write_chunk(this->out, "IEND", {});
+    this->out.flush();
+    return this->out.good() && this->rowsWritten == this->height;
+}
+
+void png_writer::flush_data(bool all) {
+    std::size_t sent = 0;
+    while (this->compressed.size() - sent >= CHUNK_SIZE) {
+        write_chunk(this->out, "IDAT", {this->compressed.data() + sent, CHUNK_SIZE});
+        sent += CHUNK_SIZE;
+    }
+    if (all && sent < this->compressed.size()) {
+        write_chunk(this->out, "IDAT", {this->compressed.data() + sent, this->compressed.size() - sent});
+        sent = this->compressed.size();
+    }
+    this->compressed.erase(this->compressed.begin(), this->compressed.begin() + static_cast<std::ptrdiff_t>(sent));
+}
+
+bool rt::write_png(std::ostream& out, const_bitmap_view image, const png_options& options, thread_pool& pool) {
+    const auto width = image.get_width();
+    const auto height = image.get_height();
+    const auto rowSize = width * BYTES_PER_PIXEL + 1;
+    const auto stripRows = std::max<std::size_t>(STRIP_SIZE / rowSize, 1);
+    const auto dictionaryRows = (DICTIONARY_SIZE + rowSize - 1) / rowSize;
+
+    // Strips are tiles one column wide, each covering stripRows rows of the image
+    const tile_scheduler scheduler{1, height, stripRows, options.threadCount, pool};
+    struct strip {
+        std::vector<unsigned char> compressed;
+        std::uint32_t adler = 1;
+        std::size_t size = 0;
+        bool done = false;
+    };
+    std::vector<strip> strips(scheduler.get_tiles().size());
+
+    write_header(out, width, height);
+    std::vector<unsigned char> compressed;
+    put_zlib_header(options.level, compressed);
+    std::uint32_t adler = 1;
+    // Whichever thread finishes a strip sends every strip that is now next in line, holding the lock
+    std::mutex outMutex;
+    std::size_t nextToSend = 0;
+
+    // Strips only read the image, so each one can redo the filtering of the rows its dictionary comes from
+    scheduler.run([&](const tile& t) {
+        const auto first = t.y;
+        const auto last = t.y + t.height;
+        const auto start = first - std::min(first, dictionaryRows);
+
+        std::vector<unsigned char> current(width * BYTES_PER_PIXEL);
+        std::vector<unsigned char> previous(width * BYTES_PER_PIXEL);
+        std::vector<unsigned char> filtered(rowSize);
+        std::vector<unsigned char> candidate(rowSize);
+        std::vector<unsigned char> data;
+        data.reserve((last - start) * rowSize);
+        if (start > 0) {
+            to_rgb8(image.row(start - 1), previous.data());
+        }
+        for (auto y = start; y < last; y++) {
+            to_rgb8(image.row(y), current.data());
+            filter_row(current, previous, filtered, candidate);
+            data.insert(data.end(), filtered.begin(), filtered.end());
+            std::swap(current, previous);
+        }
+
+        const std::span all{data};
+        const auto dictionarySize = (first - start) * rowSize;
+        strip result;
+        deflate_encoder encoder{options.level};
+        encoder.set_dictionary(all.first(dictionarySize));
+        encoder.write(all.subspan(dictionarySize), result.compressed);
+        if (last == height) {
+            encoder.finish(result.compressed);
+        } else {
+            encoder.flush(result.compressed);
+        }
+        result.adler = adler32(all.subspan(dictionarySize));
+        result.size = all.size() - dictionarySize;
+        result.done = true;
+
+        std::scoped_lock lock{outMutex};
+        strips[first / stripRows] = std::move(result);
+        for (; nextToSend < strips.size() && strips[nextToSend].done; nextToSend++) {
+            auto& s = strips[nextToSend];
+            compressed.insert(compressed.end(), s.compressed.begin(), s.compressed.end());
+            std::vector<unsigned char>{}.swap(s.compressed);
+            adler = adler32_combine(adler, s.adler, s.size);
+            std::size_t sent = 0;
+            for (; compressed.size() - sent >= CHUNK_SIZE; sent += CHUNK_SIZE) {
+                write_chunk(out, "IDAT", {compressed.data() + sent, CHUNK_SIZE});
+            }
+            compressed.erase(compressed.begin(), compressed.begin() + static_cast<std::ptrdiff_t>(sent));
+        }
+    });
+
+    if (strips.empty()) {
+        // No rows at all still needs a valid, empty stream
+        deflate_encoder{options.level}.finish(compressed);
+    }
+    put_adler(adler, compressed);
+    write_chunk(out, "IDAT", compressed);
+    write_chunk(out, "IEND", {});
+    out.flush();
+    return out.good();
+}
+
+std::vector<unsigned char> rt::encode_png(const_bitmap_view image, const png_options& options, thread_pool& pool) {
+    std::vector<unsigned char> out;
+    vector_buffer buffer{out};
+    std::ostream stream{&buffer};
+    write_png(stream, image, options, pool);
+    return out;
+}
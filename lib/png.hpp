@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "bitmap.hpp"
+#include "color.hpp"
+#include "deflate.hpp"
+#include "thread_pool.hpp"
+
+namespace rt {
+
+// Running CRC-32 as used by PNG chunks, start with 0
+[[nodiscard]] std::uint32_t crc32(std::span<const unsigned char> data, std::uint32_t crc = 0);
+
+// Encodes an 8 bit RGB PNG a row at a time as the rows become available, writing IDAT chunks as compressed data piles up.
+// Only two rows and the compressor's window are held in memory, however large the image.
+class png_writer {
+public:
+    png_writer(std::ostream& out_, std::size_t width_, std::size_t height_, int level = deflate_encoder::DEFAULT_LEVEL);
+
+    // Rows go from the top, each holding the image's width in pixels
+    void write_row(std::span<const color> row);
+    void write_rows(const_bitmap_view rows) {
+        for (std::size_t y = 0; y < rows.get_height(); y++) {
+            this->write_row(rows.row(y));
+        }
+    }
+    // Ends the file, returns false if the stream failed or the image didn't get every row
+    bool finish();
+
+private:
+    // Sends the compressed data as IDAT chunks, all of it or only full chunks
+    void flush_data(bool all);
+
+    std::ostream& out;
+    std::size_t width;
+    std::size_t height;
+    std::size_t rowsWritten = 0;
+    deflate_encoder encoder;
+    std::uint32_t adler = 1;
+
+    // Current and previous row as 8 bit RGB, filters predict from the pixel to the left and the row above
+    std::vector<unsigned char> current;
+    std::vector<unsigned char> previous;
+    // Filter type byte followed by the filtered row, the best filter so far and the one being tried
+    std::vector<unsigned char> filtered;
+    std::vector<unsigned char> candidate;
+    std::vector<unsigned char> compressed;
+};
+
+struct png_options {
+    // 0 stores the data uncompressed, 1 is the fastest and 9 the smallest
+    int level = deflate_encoder::DEFAULT_LEVEL;
+    // 0 uses every thread of the pool
+    unsigned int threadCount = 0;
+};
+
+// Encodes a whole image, filtering and compressing strips of rows in parallel on the pool the way pigz does.
+// Strips start out with the 32 KB before them as their dictionary and end on a byte boundary, so they join into one
+// zlib stream that compresses almost as well as png_writer's. Returns false if the stream failed.
+bool write_png(std::ostream& out, const_bitmap_view image, const png_options& options = {}, thread_pool& pool = thread_pool::get_global()); // NOLINT(modernize-use-nodiscard)
+// Same as write_png() but into memory, the file is written straight into the returned buffer
+[[nodiscard]] std::vector<unsigned char> encode_png(const_bitmap_view image, const png_options& options = {}, thread_pool& pool = thread_pool::get_global());
+
+} // namespace rt
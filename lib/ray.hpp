@@ -1,5 +1,6 @@
 #pragma once
 
+#include "affine.hpp"
 #include "mat.hpp"
 
 namespace rt {
@@ -33,6 +34,9 @@ struct ray {
     [[nodiscard]] constexpr ray transform(const mat<4, 4>& transformation) const {
         return {transformation * this->origin, transformation * this->direction};
     }
+    [[nodiscard]] constexpr ray transform(const affine3x4& transformation) const {
+        return {transformation * this->origin, transformation * this->direction};
+    }
 
     [[nodiscard]] constexpr bool operator==(ray other) const {
         return this->origin == other.origin && this->direction == other.direction;
@@ -57,6 +61,12 @@ struct ray {
     constexpr void operator*=(const mat<4, 4>& transformation) {
         *this = this->transform(transformation);
     }
+    [[nodiscard]] constexpr ray operator*(const affine3x4& transformation) const {
+        return this->transform(transformation);
+    }
+    constexpr void operator*=(const affine3x4& transformation) {
+        *this = this->transform(transformation);
+    }
 };
 
 } // namespace rt
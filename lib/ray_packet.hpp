@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ray.hpp"
+
+namespace rt {
+
+// Eight rays in structure of arrays form, for coherent rays like neighbouring camera rays that walk the same nodes
+struct alignas(32) ray_packet {
+    static constexpr std::size_t SIZE = 8;
+
+    float origin[3][SIZE] {};
+    float direction[3][SIZE] {};
+    // Bit per lane holding a ray, the other lanes are ignored by every query
+    std::uint32_t mask = 0;
+
+    constexpr void set(std::size_t lane, ray r) {
+        this->origin[0][lane] = r.origin.x;
+        this->origin[1][lane] = r.origin.y;
+        this->origin[2][lane] = r.origin.z;
+        this->direction[0][lane] = r.direction.x;
+        this->direction[1][lane] = r.direction.y;
+        this->direction[2][lane] = r.direction.z;
+        this->mask |= 1u << lane;
+    }
+    [[nodiscard]] constexpr ray get(std::size_t lane) const {
+        return {vec::make_point(this->origin[0][lane], this->origin[1][lane], this->origin[2][lane]),
+                vec::make_vector(this->direction[0][lane], this->direction[1][lane], this->direction[2][lane])};
+    }
+    [[nodiscard]] constexpr bool is_active(std::size_t lane) const {
+        return (this->mask >> lane) & 1u;
+    }
+};
+
+} // namespace rt
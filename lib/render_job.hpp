@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <stop_token>
+
+#include "bitmap.hpp"
+#include "thread_pool.hpp"
+
+namespace rt {
+
+// Handle to a render running on the thread pool, copies share the same render
+class render_job {
+public:
+    // Stops handing out tiles, the ones already being traced still finish
+    void cancel() {
+        this->state->stop.request_stop();
+    }
+    [[nodiscard]] bool is_cancelled() const {
+        return this->state->stop.stop_requested();
+    }
+    [[nodiscard]] bool is_done() const {
+        return this->state->done.load(std::memory_order_acquire);
+    }
+    // Fraction of tiles finished, in [0, 1]
+    [[nodiscard]] float progress() const {
+        if (this->state->tileCount == 0) {
+            return 1.f;
+        }
+        return static_cast<float>(this->state->finishedTiles.load(std::memory_order_relaxed)) / static_cast<float>(this->state->tileCount);
+    }
+
+    // Blocks until every tile is done or the render stopped after cancel(), tracing queued tiles on the calling thread
+    // meanwhile and sleeping once there are none.
+    // Tiles a cancelled render never got to are left black. If tracing a tile threw, the render stops and this rethrows it.
+    const bitmap& wait() const {
+        this->state->pool.wait_until([this] {
+            return this->is_done();
+        });
+        if (this->state->error) {
+            std::rethrow_exception(this->state->error);
+        }
+        return this->state->pixels;
+    }
+
+private:
+    friend class world;
+
+    struct shared_state {
+        shared_state(std::size_t width, std::size_t height, std::size_t tileCount_, thread_pool& pool_)
+                : pixels(width, height)
+                , tileCount(tileCount_)
+                , pool(pool_) {}
+
+        bitmap pixels;
+        std::size_t tileCount;
+        thread_pool& pool;
+        std::stop_source stop;
+        std::atomic<std::size_t> finishedTiles{0};
+        // Written before done is set, and only read after
+        std::exception_ptr error;
+        std::atomic<bool> done{false};
+    };
+
+    explicit render_job(std::shared_ptr<shared_state> state_) : state(std::move(state_)) {}
+
+    std::shared_ptr<shared_state> state;
+};
+
+} // namespace rt
@@ -0,0 +1,82 @@
+#include "scene.hpp"
+
+#include <fstream>
+#include <sstream>
+
+using namespace rt;
+
+bool scene::load(std::istream& in, std::string& error) {
+    this->clear();
+
+    std::string line;
+    for (int lineNumber = 1; std::getline(in, line); lineNumber++) {
+        std::istringstream words{line};
+        std::string keyword;
+        if (!(words >> keyword) || keyword.starts_with('#')) {
+            continue;
+        }
+        const auto fail = [&](std::string_view message) {
+            error = "line " + std::to_string(lineNumber) + ": " + std::string{message};
+            this->clear();
+            return false;
+        };
+
+        if (keyword == "camera") {
+            float v[10];
+            for (auto& value : v) {
+                if (!(words >> value)) {
+                    return fail("camera needs an origin, forward and up vector and a field of view");
+                }
+            }
+            this->cameraOrigin = vec::make_point(v[0], v[1], v[2]);
+            this->cameraForward = vec::make_vector(v[3], v[4], v[5]).normalize();
+            this->cameraUp = vec::make_vector(v[6], v[7], v[8]).normalize();
+            this->cameraFov = v[9] * PI / 180;
+        } else if (keyword == "sphere") {
+            float v[6];
+            int count = 0;
+            while (count < 6 && words >> v[count]) {
+                count++;
+            }
+            if (count == 4) {
+                this->sceneWorld->add<sphere>(vec::make_point(v[0], v[1], v[2]), vec::make_vector(v[3]));
+            } else if (count == 6) {
+                this->sceneWorld->add<sphere>(vec::make_point(v[0], v[1], v[2]), vec::make_vector(v[3], v[4], v[5]));
+            } else {
+                return fail("sphere needs a center and one or three scale values");
+            }
+        } else {
+            return fail("unknown keyword '" + keyword + "'");
+        }
+
+        // Reading numbers may have stopped at a word, which still has to be reported
+        words.clear();
+        std::string extra;
+        if (words >> extra && !extra.starts_with('#')) {
+            return fail("unexpected '" + extra + "' after " + keyword);
+        }
+    }
+    return true;
+}
+
+bool scene::load(std::string_view filepath, std::string& error) {
+    std::ifstream file{std::string{filepath}};
+    if (!file) {
+        error = "could not open " + std::string{filepath};
+        this->clear();
+        return false;
+    }
+    return this->load(file, error);
+}
+
+void scene::make_default() {
+    this->clear();
+    this->sceneWorld->add<sphere>(vec::make_point(0, 0, 0), vec::make_vector(1));
+    this->sceneWorld->add<sphere>(vec::make_point(-2.5f, 0.5f, 2), vec::make_vector(1));
+    this->sceneWorld->add<sphere>(vec::make_point(2.5f, -0.5f, 2), vec::make_vector(1));
+    this->sceneWorld->add<sphere>(vec::make_point(0, -101, 0), vec::make_vector(100));
+}
+
+void scene::clear() {
+    *this = scene{};
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "camera.hpp"
+#include "math.hpp"
+#include "world.hpp"
+
+namespace rt {
+
+// A world and where to look at it from, read from a line based text format:
+//   # comment
+//   camera <origin xyz> <forward xyz> <up xyz> <vertical fov in degrees>
+//   sphere <center xyz> <scale, or scale xyz>
+class scene {
+public:
+    scene() = default;
+
+    // Returns false and describes the first problem in error if the scene can't be read, the scene is left empty then
+    bool load(std::istream& in, std::string& error);
+    bool load(std::string_view filepath, std::string& error);
+
+    // A few spheres on a large ground sphere, for when no scene is given
+    void make_default();
+
+    [[nodiscard]] world& get_world() {
+        return *this->sceneWorld;
+    }
+    [[nodiscard]] const world& get_world() const {
+        return *this->sceneWorld;
+    }
+
+    [[nodiscard]] camera make_camera(std::size_t width, std::size_t height) const {
+        return {this->cameraOrigin, this->cameraForward, this->cameraUp, this->cameraFov, width, height};
+    }
+
+private:
+    void clear();
+
+    std::unique_ptr<world> sceneWorld = std::make_unique<world>();
+    vec cameraOrigin = vec::make_point(0, 0, -5);
+    vec cameraForward = vec::make_vector(0, 0, 1);
+    vec cameraUp = vec::make_vector(0, 1, 0);
+    float cameraFov = PI_2;
+};
+
+} // namespace rt
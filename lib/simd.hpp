@@ -0,0 +1,123 @@
+#pragma once
+
+// Picks the widest instruction set the compiler is allowed to emit.
+// Everything using these must keep a scalar fallback for constant evaluation and other targets.
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define RT_SIMD_SSE
+    #include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #define RT_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+#if defined(__AVX2__)
+    #define RT_SIMD_AVX2
+    #include <immintrin.h>
+#endif
+
+#if defined(RT_SIMD_SSE) || defined(RT_SIMD_NEON)
+    #define RT_SIMD
+
+namespace rt::simd {
+
+// Four floats in one register, loads and stores must be 16 byte aligned
+#if defined(RT_SIMD_SSE)
+using f32x4 = __m128;
+
+[[nodiscard]] inline f32x4 load(const float* values) {
+    return _mm_load_ps(values);
+}
+inline void store(float* values, f32x4 v) {
+    _mm_store_ps(values, v);
+}
+[[nodiscard]] inline f32x4 broadcast(float value) {
+    return _mm_set1_ps(value);
+}
+[[nodiscard]] inline f32x4 add(f32x4 a, f32x4 b) {
+    return _mm_add_ps(a, b);
+}
+[[nodiscard]] inline f32x4 sub(f32x4 a, f32x4 b) {
+    return _mm_sub_ps(a, b);
+}
+[[nodiscard]] inline f32x4 mul(f32x4 a, f32x4 b) {
+    return _mm_mul_ps(a, b);
+}
+[[nodiscard]] inline f32x4 div(f32x4 a, f32x4 b) {
+    return _mm_div_ps(a, b);
+}
+[[nodiscard]] inline float sum(f32x4 v) {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(v);
+}
+// Estimate refined with one Newton-Raphson step, good to about 22 bits
+[[nodiscard]] inline f32x4 reciprocal_sqrt(f32x4 v) {
+    const f32x4 estimate = _mm_rsqrt_ps(v);
+    const f32x4 refinement = _mm_mul_ps(_mm_mul_ps(v, estimate), estimate);
+    return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), estimate), _mm_sub_ps(_mm_set1_ps(3.f), refinement));
+}
+// Cross product of the xyz lanes, w is a.w * b.w - a.w * b.w
+[[nodiscard]] inline f32x4 cross(f32x4 a, f32x4 b) {
+    const f32x4 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    const f32x4 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    const f32x4 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+    return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+#elif defined(RT_SIMD_NEON)
+using f32x4 = float32x4_t;
+
+[[nodiscard]] inline f32x4 load(const float* values) {
+    return vld1q_f32(values);
+}
+inline void store(float* values, f32x4 v) {
+    vst1q_f32(values, v);
+}
+[[nodiscard]] inline f32x4 broadcast(float value) {
+    return vdupq_n_f32(value);
+}
+[[nodiscard]] inline f32x4 add(f32x4 a, f32x4 b) {
+    return vaddq_f32(a, b);
+}
+[[nodiscard]] inline f32x4 sub(f32x4 a, f32x4 b) {
+    return vsubq_f32(a, b);
+}
+[[nodiscard]] inline f32x4 mul(f32x4 a, f32x4 b) {
+    return vmulq_f32(a, b);
+}
+[[nodiscard]] inline f32x4 div(f32x4 a, f32x4 b) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+    return vdivq_f32(a, b);
+#else
+    f32x4 reciprocal = vrecpeq_f32(b);
+    reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+    reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+    return vmulq_f32(a, reciprocal);
+#endif
+}
+[[nodiscard]] inline float sum(f32x4 v) {
+    const float32x2_t pairs = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+}
+// Estimate refined with two Newton-Raphson steps
+[[nodiscard]] inline f32x4 reciprocal_sqrt(f32x4 v) {
+    f32x4 estimate = vrsqrteq_f32(v);
+    estimate = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, estimate), estimate), estimate);
+    estimate = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, estimate), estimate), estimate);
+    return estimate;
+}
+// Cross product of the xyz lanes, w is a.w * b.w - a.w * b.w
+[[nodiscard]] inline f32x4 cross(f32x4 a, f32x4 b) {
+    // (y, z, x, w) from (x, y, z, w)
+    const auto yzx = [](f32x4 v) {
+        const float32x4_t yzwx = vextq_f32(v, v, 1);
+        return vsetq_lane_f32(vgetq_lane_f32(v, 3), vsetq_lane_f32(vgetq_lane_f32(v, 0), yzwx, 2), 3);
+    };
+    const f32x4 c = vsubq_f32(vmulq_f32(a, yzx(b)), vmulq_f32(yzx(a), b));
+    return yzx(c);
+}
+#endif
+
+} // namespace rt::simd
+
+#endif
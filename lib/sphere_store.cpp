@@ -0,0 +1,201 @@
+#include "sphere_store.hpp"
+
+#include <bit>
+#include <cmath>
+
+#include "simd.hpp"
+
+using namespace rt;
+
+void sphere_store::resize(std::size_t size) {
+    for (auto& row : this->inverse) {
+        row.assign(size + LANES, 0.f);
+    }
+    this->enabled.assign(size + LANES, 0.f);
+}
+
+void sphere_store::set(std::size_t slot, const affine3x4& inverseTransform) {
+    for (int i = 0; i < 12; i++) {
+        this->inverse[i][slot] = inverseTransform(i / 4, i % 4);
+    }
+    this->enabled[slot] = 1.f;
+}
+
+void sphere_store::disable(std::size_t slot) {
+    this->enabled[slot] = 0.f;
+}
+
+#ifdef RT_SIMD_AVX2
+
+namespace {
+
+// Object space origin and direction, one ray per lane
+struct object_space_rays {
+    __m256 origin[3];
+    __m256 direction[3];
+};
+
+// Distance to the unit sphere for each lane in [0, maxDistance), lanes that miss are +infinity
+[[nodiscard]] __m256 get_distances(const object_space_rays& rays, __m256 maxDistance) {
+    const auto& o = rays.origin;
+    const auto& d = rays.direction;
+    const __m256 a = _mm256_fmadd_ps(d[2], d[2], _mm256_fmadd_ps(d[1], d[1], _mm256_mul_ps(d[0], d[0])));
+    const __m256 halfB = _mm256_fmadd_ps(d[2], o[2], _mm256_fmadd_ps(d[1], o[1], _mm256_mul_ps(d[0], o[0])));
+    const __m256 c = _mm256_sub_ps(_mm256_fmadd_ps(o[2], o[2], _mm256_fmadd_ps(o[1], o[1], _mm256_mul_ps(o[0], o[0]))), _mm256_set1_ps(1.f));
+
+    // (b / 2)^2 - ac is a quarter of the usual discriminant, which cancels out against 2a
+    // Not fused, so both products round the same way and grazing rays agree with the scalar path
+    const __m256 discriminant = _mm256_sub_ps(_mm256_mul_ps(halfB, halfB), _mm256_mul_ps(a, c));
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 root = _mm256_sqrt_ps(_mm256_max_ps(discriminant, zero));
+    const __m256 nearDistance = _mm256_div_ps(_mm256_sub_ps(_mm256_sub_ps(zero, halfB), root), a);
+    const __m256 farDistance = _mm256_div_ps(_mm256_sub_ps(root, halfB), a);
+    const __m256 distance = _mm256_blendv_ps(farDistance, nearDistance, _mm256_cmp_ps(nearDistance, zero, _CMP_GE_OQ));
+
+    __m256 hit = _mm256_cmp_ps(discriminant, zero, _CMP_GE_OQ);
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(distance, maxDistance, _CMP_LT_OQ));
+    return _mm256_blendv_ps(_mm256_set1_ps(INFINITY), distance, hit);
+}
+
+// One ray against the eight spheres starting at first, lanes out of range or disabled are +infinity
+[[nodiscard]] __m256 get_distances(const std::vector<float> (&inverse)[12], const std::vector<float>& enabled, ray r, std::size_t first, std::size_t count, float maxDistance) {
+    const float origin[3] {r.origin.x, r.origin.y, r.origin.z};
+    const float direction[3] {r.direction.x, r.direction.y, r.direction.z};
+    object_space_rays rays;
+    for (int i = 0; i < 3; i++) {
+        rays.origin[i] = _mm256_loadu_ps(inverse[i * 4 + 3].data() + first);
+        rays.direction[i] = _mm256_setzero_ps();
+        for (int j = 0; j < 3; j++) {
+            const __m256 m = _mm256_loadu_ps(inverse[i * 4 + j].data() + first);
+            rays.origin[i] = _mm256_fmadd_ps(m, _mm256_set1_ps(origin[j]), rays.origin[i]);
+            rays.direction[i] = _mm256_fmadd_ps(m, _mm256_set1_ps(direction[j]), rays.direction[i]);
+        }
+    }
+    const __m256 distances = get_distances(rays, _mm256_set1_ps(maxDistance));
+
+    __m256 valid = _mm256_cmp_ps(_mm256_loadu_ps(enabled.data() + first), _mm256_setzero_ps(), _CMP_NEQ_OQ);
+    valid = _mm256_and_ps(valid, _mm256_cmp_ps(_mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_ps(static_cast<float>(count)), _CMP_LT_OQ));
+    return _mm256_blendv_ps(_mm256_set1_ps(INFINITY), distances, valid);
+}
+
+} // namespace
+
+bool sphere_store::closest_intersection(ray r, std::size_t first, std::size_t count, float& maxDistance, std::size_t& slot) const {
+    const __m256 distances = get_distances(this->inverse, this->enabled, r, first, count, maxDistance);
+
+    // Horizontal minimum, then the first lane holding it
+    __m256 minimum = _mm256_min_ps(distances, _mm256_permute2f128_ps(distances, distances, 1));
+    minimum = _mm256_min_ps(minimum, _mm256_shuffle_ps(minimum, minimum, _MM_SHUFFLE(1, 0, 3, 2)));
+    minimum = _mm256_min_ps(minimum, _mm256_shuffle_ps(minimum, minimum, _MM_SHUFFLE(2, 3, 0, 1)));
+    const float closest = _mm256_cvtss_f32(minimum);
+    if (!(closest < maxDistance)) {
+        return false;
+    }
+    const auto lanes = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(distances, minimum, _CMP_EQ_OQ)));
+    slot = first + static_cast<std::size_t>(std::countr_zero(lanes));
+    maxDistance = closest;
+    return true;
+}
+
+bool sphere_store::intersects(ray r, std::size_t first, std::size_t count, float maxDistance) const {
+    const __m256 distances = get_distances(this->inverse, this->enabled, r, first, count, maxDistance);
+    return _mm256_movemask_ps(_mm256_cmp_ps(distances, _mm256_set1_ps(INFINITY), _CMP_NEQ_OQ)) != 0;
+}
+
+std::uint32_t sphere_store::closest_intersections(const ray_packet& packet, std::uint32_t mask, std::size_t first, std::size_t count, float (&maxDistances)[ray_packet::SIZE], std::size_t (&slots)[ray_packet::SIZE]) const {
+    __m256 origin[3], direction[3];
+    for (int i = 0; i < 3; i++) {
+        origin[i] = _mm256_loadu_ps(packet.origin[i]);
+        direction[i] = _mm256_loadu_ps(packet.direction[i]);
+    }
+    const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256 active = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(mask)), laneBits), laneBits));
+    __m256 closest = _mm256_loadu_ps(maxDistances);
+    std::uint32_t found = 0;
+    for (std::size_t slot = first; slot < first + count; slot++) {
+        if (!this->is_enabled(slot)) {
+            continue;
+        }
+        // Same transform for every lane this time, the rays differ
+        object_space_rays rays;
+        for (int i = 0; i < 3; i++) {
+            rays.origin[i] = _mm256_set1_ps(this->inverse[i * 4 + 3][slot]);
+            rays.direction[i] = _mm256_setzero_ps();
+            for (int j = 0; j < 3; j++) {
+                const __m256 m = _mm256_set1_ps(this->inverse[i * 4 + j][slot]);
+                rays.origin[i] = _mm256_fmadd_ps(m, origin[j], rays.origin[i]);
+                rays.direction[i] = _mm256_fmadd_ps(m, direction[j], rays.direction[i]);
+            }
+        }
+        const __m256 distances = get_distances(rays, closest);
+        const __m256 hit = _mm256_and_ps(_mm256_cmp_ps(distances, _mm256_set1_ps(INFINITY), _CMP_NEQ_OQ), active);
+        auto lanes = static_cast<std::uint32_t>(_mm256_movemask_ps(hit));
+        if (lanes == 0) {
+            continue;
+        }
+        closest = _mm256_blendv_ps(closest, distances, hit);
+        found |= lanes;
+        for (; lanes != 0; lanes &= lanes - 1) {
+            slots[std::countr_zero(lanes)] = slot;
+        }
+    }
+    _mm256_storeu_ps(maxDistances, closest);
+    return found;
+}
+
+#else
+
+namespace {
+
+// Same math as sphere::closest_intersection, reading the transform from the store
+[[nodiscard]] bool get_distance(const std::vector<float> (&inverse)[12], std::size_t slot, ray r, float maxDistance, float& distance) {
+    const affine3x4 transform{
+        inverse[0][slot], inverse[1][slot], inverse[2][slot], inverse[3][slot],
+        inverse[4][slot], inverse[5][slot], inverse[6][slot], inverse[7][slot],
+        inverse[8][slot], inverse[9][slot], inverse[10][slot], inverse[11][slot]
+    };
+    float nearDistance, farDistance;
+    if (!unit_sphere_roots(r * transform, nearDistance, farDistance)) {
+        return false;
+    }
+    distance = nearDistance >= 0 ? nearDistance : farDistance;
+    return distance >= 0 && distance < maxDistance;
+}
+
+} // namespace
+
+bool sphere_store::closest_intersection(ray r, std::size_t first, std::size_t count, float& maxDistance, std::size_t& slot) const {
+    bool found = false;
+    for (std::size_t i = first; i < first + count; i++) {
+        float distance;
+        if (this->is_enabled(i) && get_distance(this->inverse, i, r, maxDistance, distance)) {
+            maxDistance = distance;
+            slot = i;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool sphere_store::intersects(ray r, std::size_t first, std::size_t count, float maxDistance) const {
+    for (std::size_t i = first; i < first + count; i++) {
+        float distance;
+        if (this->is_enabled(i) && get_distance(this->inverse, i, r, maxDistance, distance)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::uint32_t sphere_store::closest_intersections(const ray_packet& packet, std::uint32_t mask, std::size_t first, std::size_t count, float (&maxDistances)[ray_packet::SIZE], std::size_t (&slots)[ray_packet::SIZE]) const {
+    std::uint32_t found = 0;
+    for (std::size_t lane = 0; lane < ray_packet::SIZE; lane++) {
+        if (((mask >> lane) & 1u) && this->closest_intersection(packet.get(lane), first, count, maxDistances[lane], slots[lane])) {
+            found |= 1u << lane;
+        }
+    }
+    return found;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "affine.hpp"
+#include "ray.hpp"
+#include "ray_packet.hpp"
+
+namespace rt {
+
+// Solves for where a ray in object space enters and leaves the unit sphere. Shared by sphere and the scalar
+// kernel so the two round identically.
+[[nodiscard]] inline bool unit_sphere_roots(ray r, float& nearDistance, float& farDistance) {
+    auto sphereToRay = r.origin - vec::make_point(0,0,0);
+    auto a = r.direction * r.direction;
+    auto b = r.direction * sphereToRay * 2;
+    auto c = sphereToRay * sphereToRay - 1;
+    auto d = b * b - (4 * a * c);
+    if (d < 0) {
+        return false;
+    }
+    const auto root = std::sqrt(d);
+    nearDistance = (-b - root) / (2 * a);
+    farDistance = (-b + root) / (2 * a);
+    return true;
+}
+
+// Structure of arrays copy of sphere inverse transforms, tested against one ray eight spheres at a time when built with
+// AVX2 (RAYTRACER_ENABLE_AVX2) and one at a time otherwise. Slots that are not spheres are disabled and never report a hit.
+class sphere_store {
+public:
+    static constexpr std::size_t LANES = 8;
+
+    sphere_store() {
+        this->resize(0);
+    }
+
+    void resize(std::size_t size);
+    [[nodiscard]] std::size_t size() const {
+        return this->enabled.size() - LANES;
+    }
+
+    void set(std::size_t slot, const affine3x4& inverseTransform);
+    void disable(std::size_t slot);
+    [[nodiscard]] bool is_enabled(std::size_t slot) const {
+        return this->enabled[slot] != 0.f;
+    }
+
+    // Closest sphere hit in [0, maxDistance) among at most LANES slots starting at first, lowers maxDistance and sets slot if found
+    [[nodiscard]] bool closest_intersection(ray r, std::size_t first, std::size_t count, float& maxDistance, std::size_t& slot) const;
+    // True if any sphere in the slots is hit in [0, maxDistance)
+    [[nodiscard]] bool intersects(ray r, std::size_t first, std::size_t count, float maxDistance) const;
+    // Packet version of closest_intersection() for the lanes in mask, any number of slots, returns the lanes that found a hit
+    [[nodiscard]] std::uint32_t closest_intersections(const ray_packet& packet, std::uint32_t mask, std::size_t first, std::size_t count, float (&maxDistances)[ray_packet::SIZE], std::size_t (&slots)[ray_packet::SIZE]) const;
+
+private:
+    // Rows of the inverse transforms, padded by LANES so a full batch can always be loaded
+    std::vector<float> inverse[12];
+    std::vector<float> enabled;
+};
+
+} // namespace rt
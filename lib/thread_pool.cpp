@@ -0,0 +1,128 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+using namespace rt;
+
+namespace {
+
+// Lets tasks submitted from a worker go to the back of that worker's own deque
+thread_local thread_pool* currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+} // namespace
+
+thread_pool::thread_pool(unsigned int threadCount) {
+    if (!threadCount) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (unsigned int i = 0; i < threadCount; i++) {
+        this->queues.push_back(std::make_unique<worker_queue>());
+    }
+    for (unsigned int i = 0; i < threadCount; i++) {
+        this->workers.emplace_back([this, i] {
+            this->work(i);
+        });
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::scoped_lock lock{this->sleepMutex};
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+    for (auto& worker : this->workers) {
+        worker.join();
+    }
+}
+
+thread_pool& thread_pool::get_global() {
+    static thread_pool pool;
+    return pool;
+}
+
+bool thread_pool::run_pending_task() {
+    std::function<void()> task;
+    if (currentPool == this) {
+        if (!this->pop(currentWorker, task) && !this->steal(currentWorker, task)) {
+            return false;
+        }
+    } else if (!this->steal(this->queues.size() - 1, task)) {
+        return false;
+    }
+    this->run(task);
+    return true;
+}
+
+void thread_pool::push(std::function<void()> task) {
+    const auto index = currentPool == this ? currentWorker : this->nextQueue.fetch_add(1, std::memory_order_relaxed) % this->queues.size();
+    {
+        // Count the task before it becomes visible so a thief can never decrement past zero
+        std::scoped_lock lock{this->sleepMutex};
+        this->pendingTasks++;
+    }
+    {
+        std::scoped_lock lock{this->queues[index]->mutex};
+        this->queues[index]->tasks.push_back(std::move(task));
+    }
+    this->wake.notify_one();
+    this->progress.notify_all();
+}
+
+bool thread_pool::pop(std::size_t index, std::function<void()>& task) {
+    auto& queue = *this->queues[index];
+    std::scoped_lock lock{queue.mutex};
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    this->pendingTasks--;
+    return true;
+}
+
+bool thread_pool::steal(std::size_t thief, std::function<void()>& task) {
+    // Take the oldest task from the other end of each victim's deque, starting with the thief's neighbour
+    for (std::size_t i = 1; i <= this->queues.size(); i++) {
+        auto& queue = *this->queues[(thief + i) % this->queues.size()];
+        std::scoped_lock lock{queue.mutex};
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        this->pendingTasks--;
+        return true;
+    }
+    return false;
+}
+
+void thread_pool::work(std::size_t index) {
+    currentPool = this;
+    currentWorker = index;
+    std::function<void()> task;
+    while (true) {
+        if (this->pop(index, task) || this->steal(index, task)) {
+            this->run(task);
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock lock{this->sleepMutex};
+        this->wake.wait(lock, [this] {
+            return this->stopping || this->pendingTasks > 0;
+        });
+        if (this->stopping && this->pendingTasks == 0) {
+            return;
+        }
+    }
+}
+
+void thread_pool::run(std::function<void()>& task) {
+    task();
+    // Taking the lock makes sure a waiter is either asleep and gets woken, or checks done() after the task
+    {
+        std::scoped_lock lock{this->sleepMutex};
+    }
+    this->progress.notify_all();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace rt {
+
+class thread_pool {
+public:
+    // 0 uses every hardware thread
+    explicit thread_pool(unsigned int threadCount = 0);
+    thread_pool(const thread_pool& other) = delete;
+    thread_pool& operator=(const thread_pool& other) = delete;
+    ~thread_pool();
+
+    // Pool shared by the whole process, so independent subsystems don't oversubscribe the cores
+    [[nodiscard]] static thread_pool& get_global();
+
+    [[nodiscard]] unsigned int get_thread_count() const {
+        return static_cast<unsigned int>(this->workers.size());
+    }
+
+    template<typename F>
+    requires std::is_invocable_v<F>
+    std::future<std::invoke_result_t<F>> submit(F&& func) {
+        auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(func));
+        auto future = task->get_future();
+        this->push([task] { (*task)(); });
+        return future;
+    }
+
+    // Runs one queued task on the calling thread, returns false if there was nothing to run
+    bool run_pending_task();
+
+    // Helps out with queued tasks until done() is true, so waiting on the pool from inside a task never deadlocks.
+    // With nothing queued it sleeps instead of taking a core from the workers, and checks done() again whenever a task
+    // finishes or is submitted, so done() has to be made true by a task on this pool.
+    template<typename P>
+    requires std::is_invocable_r_v<bool, P>
+    void wait_until(P&& done) {
+        while (!done()) {
+            if (this->run_pending_task()) {
+                continue;
+            }
+            std::unique_lock lock{this->sleepMutex};
+            this->progress.wait(lock, [&] {
+                return this->pendingTasks > 0 || done();
+            });
+        }
+    }
+
+    template<typename T>
+    T wait(std::future<T>& future) {
+        this->wait_until([&future] {
+            return future.wait_for(std::chrono::seconds{0}) == std::future_status::ready;
+        });
+        return future.get();
+    }
+
+private:
+    struct worker_queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void push(std::function<void()> task);
+    [[nodiscard]] bool pop(std::size_t index, std::function<void()>& task);
+    [[nodiscard]] bool steal(std::size_t thief, std::function<void()>& task);
+    void work(std::size_t index);
+    // Runs a task and wakes whoever is in wait_until() to check on it
+    void run(std::function<void()>& task);
+
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> nextQueue{0};
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    // Threads sleeping in wait_until()
+    std::condition_variable progress;
+    std::atomic<std::size_t> pendingTasks{0};
+    bool stopping = false;
+};
+
+} // namespace rt
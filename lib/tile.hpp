@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <stop_token>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+namespace rt {
+
+struct tile {
+    std::size_t x;
+    std::size_t y;
+    std::size_t width;
+    std::size_t height;
+
+    [[nodiscard]] constexpr bool operator==(const tile& other) const = default;
+};
+
+class tile_scheduler {
+public:
+    tile_scheduler(std::size_t width, std::size_t height, std::size_t tileSize = 32, unsigned int threadCount = 0, thread_pool& pool = thread_pool::get_global())
+            : pool(pool)
+            , threadCount(threadCount ? threadCount : pool.get_thread_count()) {
+        tileSize = std::max<std::size_t>(tileSize, 1);
+        for (std::size_t y = 0; y < height; y += std::min(tileSize, height - y)) {
+            for (std::size_t x = 0; x < width; x += std::min(tileSize, width - x)) {
+                this->tiles.push_back({x, y, std::min(tileSize, width - x), std::min(tileSize, height - y)});
+            }
+        }
+    }
+
+    [[nodiscard]] const std::vector<tile>& get_tiles() const {
+        return this->tiles;
+    }
+    [[nodiscard]] unsigned int get_thread_count() const {
+        return this->threadCount;
+    }
+
+    // Calls func once per tile, spread over the configured number of threads (the calling thread included).
+    // Tiles never overlap, so func may write to its tile's pixels without synchronization.
+    // Once stop is requested no new tiles are started, tiles that are already running still finish.
+    // If func throws, no new tiles are started either and the first exception is rethrown once every worker is done.
+    template<typename F>
+    void run(F&& func, std::stop_token stop = {}) const {
+        std::atomic<std::size_t> nextTile{0};
+        std::atomic<std::size_t> finishedWorkers{0};
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        auto worker = [&] {
+            // Workers reference this frame, so however they leave they have to be counted before run() returns
+            struct finish_guard {
+                std::atomic<std::size_t>& count;
+                ~finish_guard() {
+                    this->count++;
+                }
+            } guard{finishedWorkers};
+            try {
+                for (auto i = nextTile.fetch_add(1, std::memory_order_relaxed); i < this->tiles.size() && !stop.stop_requested(); i = nextTile.fetch_add(1, std::memory_order_relaxed)) {
+                    func(this->tiles[i]);
+                }
+            } catch (...) {
+                nextTile = this->tiles.size();
+                std::scoped_lock lock{errorMutex};
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        };
+
+        const auto workerCount = std::max<std::size_t>(std::min<std::size_t>(this->threadCount, this->tiles.size()), 1);
+        for (std::size_t i = 1; i < workerCount; i++) {
+            this->pool.submit(worker);
+        }
+        worker();
+        this->pool.wait_until([&] {
+            return finishedWorkers == workerCount;
+        });
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    thread_pool& pool;
+    std::vector<tile> tiles;
+    unsigned int threadCount;
+};
+
+} // namespace rt
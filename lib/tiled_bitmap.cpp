@@ -0,0 +1,56 @@
+#include "tiled_bitmap.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include "png.hpp"
+
+using namespace rt;
+
+bool tiled_bitmap::create(std::size_t width_, std::size_t height_, std::string& error, std::size_t tileSize_, std::filesystem::path directory) {
+    *this = tiled_bitmap{};
+    const auto tileSizeUsed = std::max<std::size_t>(tileSize_, 1);
+    const auto pageSize = mapped_file::get_page_size();
+    const auto tilesPerRow_ = (width_ + tileSizeUsed - 1) / tileSizeUsed;
+    const auto tilesPerColumn = (height_ + tileSizeUsed - 1) / tileSizeUsed;
+    const auto tileBytes_ = (tileSizeUsed * tileSizeUsed * sizeof(color) + pageSize - 1) / pageSize * pageSize;
+    if (!this->file.create(tilesPerRow_ * tilesPerColumn * tileBytes_, error, std::move(directory))) {
+        return false;
+    }
+    this->width = width_;
+    this->height = height_;
+    this->tileSize = tileSizeUsed;
+    this->tilesPerRow = tilesPerRow_;
+    this->tileBytes = tileBytes_;
+    return true;
+}
+
+void tiled_bitmap::release(const tile& t) const {
+    if (t.width == 0 || t.height == 0) {
+        return;
+    }
+    // Tiles are only contiguous along a row of tiles
+    for (auto y = t.y / this->tileSize; y <= (t.y + t.height - 1) / this->tileSize; y++) {
+        const auto first = y * this->tilesPerRow + t.x / this->tileSize;
+        const auto last = y * this->tilesPerRow + (t.x + t.width - 1) / this->tileSize;
+        this->file.release(first * this->tileBytes, (last - first + 1) * this->tileBytes);
+    }
+}
+
+void tiled_bitmap::read_row(std::size_t y, std::span<color> out) const {
+    for (std::size_t x = 0; x < this->width; x += this->tileSize) {
+        const auto count = std::min(this->tileSize, this->width - x);
+        std::memcpy(out.data() + x, this->view({x, y, count, 1}).row(0).data(), count * sizeof(color));
+    }
+}
+
+bool tiled_bitmap::save(std::string_view filepath, int level) const {
+    std::ofstream file{std::filesystem::path{filepath}, std::ios::binary};
+    png_writer png{file, this->width, this->height, level};
+    this->read_rows([&](std::size_t, std::span<const color> row) {
+        png.write_row(row);
+    });
+    return png.finish();
+}
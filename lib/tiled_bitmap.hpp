@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bitmap.hpp"
+#include "mapped_file.hpp"
+#include "tile.hpp"
+
+namespace rt {
+
+// Framebuffer kept in a memory mapped scratch file instead of RAM, for images larger than the machine could hold.
+// Pixels are stored tile by tile, so rendering a tile only touches its own pages and finished tiles can be dropped from memory.
+class tiled_bitmap {
+public:
+    tiled_bitmap() = default;
+
+    // Returns false and describes the problem in error if the scratch file can't be made, see mapped_file::create()
+    bool create(std::size_t width_, std::size_t height_, std::string& error, std::size_t tileSize_ = 64, std::filesystem::path directory = {});
+
+    [[nodiscard]] std::size_t get_width() const {
+        return this->width;
+    }
+    [[nodiscard]] std::size_t get_height() const {
+        return this->height;
+    }
+    // Tiles handed to view() must not cross a multiple of this
+    [[nodiscard]] std::size_t get_tile_size() const {
+        return this->tileSize;
+    }
+
+    [[nodiscard]] bitmap_view view(const tile& t) {
+        return {this->get_tile_pixels(t.x, t.y) + (t.y % this->tileSize) * this->tileSize + t.x % this->tileSize, t.width, t.height, this->tileSize};
+    }
+    [[nodiscard]] const_bitmap_view view(const tile& t) const {
+        return {this->get_tile_pixels(t.x, t.y) + (t.y % this->tileSize) * this->tileSize + t.x % this->tileSize, t.width, t.height, this->tileSize};
+    }
+    void set_pixel(color c, std::size_t x, std::size_t y) {
+        this->view({x, y, 1, 1})(0, 0) = c;
+    }
+    [[nodiscard]] color get_pixel(std::size_t x, std::size_t y) const {
+        return this->view({x, y, 1, 1})(0, 0);
+    }
+
+    // Lets the tiles overlapping t leave memory, they are read back from the scratch file when touched again
+    void release(const tile& t) const;
+
+    // Copies row y into out, which holds get_width() pixels
+    void read_row(std::size_t y, std::span<color> out) const;
+    // Calls func(y, row) for every row from the top, releasing each band of tiles once all its rows have been read
+    template<typename F>
+    void read_rows(F&& func) const {
+        std::vector<color> row(this->width);
+        for (std::size_t y = 0; y < this->height; y++) {
+            this->read_row(y, row);
+            func(y, std::span<const color>{row});
+            if ((y + 1) % this->tileSize == 0 || y + 1 == this->height) {
+                this->release({0, y - y % this->tileSize, this->width, y % this->tileSize + 1});
+            }
+        }
+    }
+
+    bool save(std::string_view filepath, int level = deflate_encoder::DEFAULT_LEVEL) const; // NOLINT(modernize-use-nodiscard)
+
+private:
+    [[nodiscard]] color* get_tile_pixels(std::size_t x, std::size_t y) const {
+        const auto index = (y / this->tileSize) * this->tilesPerRow + x / this->tileSize;
+        return reinterpret_cast<color*>(this->file.data() + index * this->tileBytes); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    }
+
+    std::size_t width = 0;
+    std::size_t height = 0;
+    std::size_t tileSize = 0;
+    std::size_t tilesPerRow = 0;
+    // Tiles start on a page boundary, so each can be released on its own
+    std::size_t tileBytes = 0;
+    mapped_file file;
+};
+
+} // namespace rt
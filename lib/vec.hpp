@@ -4,10 +4,12 @@
 #include <type_traits>
 
 #include "math.hpp"
+#include "simd.hpp"
 
 namespace rt {
 
-struct vec {
+// Aligned so the SIMD backend can load all four components at once
+struct alignas(16) vec {
     float x;
     float y;
     float z;
@@ -31,20 +33,35 @@ struct vec {
     }
 
     [[nodiscard]] constexpr float dot(vec other) const {
+#ifdef RT_SIMD
+        if (!std::is_constant_evaluated()) {
+            return simd::sum(simd::mul(this->to_simd(), other.to_simd()));
+        }
+#endif
         return this->x * other.x + this->y * other.y + this->z * other.z + this->w * other.w;
     }
 
     [[nodiscard]] constexpr vec cross(vec other) const {
+#ifdef RT_SIMD
+        if (!std::is_constant_evaluated()) {
+            return vec::from_simd(simd::cross(this->to_simd(), other.to_simd()));
+        }
+#endif
         return vec::make_vector(this->y * other.z - this->z * other.y,
                                 this->z * other.x - this->x * other.z,
                                 this->x * other.y - this->y * other.x);
     }
 
     [[nodiscard]] float magnitude() const {
-        return std::sqrtf(std::powf(this->x, 2) + std::powf(this->y, 2) + std::powf(this->z, 2) + std::powf(this->w, 2));
+        return std::sqrt(this->dot(*this));
     }
     [[nodiscard]] vec normalize() const {
+#ifdef RT_SIMD
+        const auto v = this->to_simd();
+        return vec::from_simd(simd::mul(v, simd::reciprocal_sqrt(simd::broadcast(simd::sum(simd::mul(v, v))))));
+#else
         return *this / this->magnitude();
+#endif
     }
     [[nodiscard]] bool is_unit_vector() const {
         return float_eq(this->magnitude(), 1.f);
@@ -64,22 +81,26 @@ struct vec {
         return {-this->x, -this->y, -this->z, -this->w};
     }
     [[nodiscard]] constexpr vec operator+(vec other) const {
+#ifdef RT_SIMD
+        if (!std::is_constant_evaluated()) {
+            return vec::from_simd(simd::add(this->to_simd(), other.to_simd()));
+        }
+#endif
         return {this->x + other.x, this->y + other.y, this->z + other.z, this->w + other.w};
     }
     [[nodiscard]] constexpr vec operator-(vec other) const {
+#ifdef RT_SIMD
+        if (!std::is_constant_evaluated()) {
+            return vec::from_simd(simd::sub(this->to_simd(), other.to_simd()));
+        }
+#endif
         return {this->x - other.x, this->y - other.y, this->z - other.z, this->w - other.w};
     }
     constexpr void operator+=(vec other) {
-        this->x += other.x;
-        this->y += other.y;
-        this->z += other.z;
-        this->w += other.w;
+        *this = *this + other;
     }
     constexpr void operator-=(vec other) {
-        this->x -= other.x;
-        this->y -= other.y;
-        this->z -= other.z;
-        this->w -= other.w;
+        *this = *this - other;
     }
     [[nodiscard]] constexpr float operator*(vec other) const {
         return this->dot(other);
@@ -88,29 +109,44 @@ struct vec {
     template<typename T>
     requires std::is_arithmetic_v<T>
     [[nodiscard]] constexpr vec operator*(T other) const {
+#ifdef RT_SIMD
+        if (!std::is_constant_evaluated()) {
+            return vec::from_simd(simd::mul(this->to_simd(), simd::broadcast(static_cast<float>(other))));
+        }
+#endif
         return {this->x * other, this->y * other, this->z * other, this->w * other};
     }
     template<typename T>
     requires std::is_arithmetic_v<T>
     [[nodiscard]] constexpr vec operator/(T other) const {
+#ifdef RT_SIMD
+        if (!std::is_constant_evaluated()) {
+            return vec::from_simd(simd::div(this->to_simd(), simd::broadcast(static_cast<float>(other))));
+        }
+#endif
         return {this->x / other, this->y / other, this->z / other, this->w / other};
     }
     template<typename T>
     requires std::is_arithmetic_v<T>
     constexpr void operator*=(T other) {
-        this->x *= other;
-        this->y *= other;
-        this->z *= other;
-        this->w *= other;
+        *this = *this * other;
     }
     template<typename T>
     requires std::is_arithmetic_v<T>
     constexpr void operator/=(T other) {
-        this->x /= other;
-        this->y /= other;
-        this->z /= other;
-        this->w /= other;
+        *this = *this / other;
     }
+
+#ifdef RT_SIMD
+    [[nodiscard]] simd::f32x4 to_simd() const {
+        return simd::load(&this->x);
+    }
+    [[nodiscard]] static vec from_simd(simd::f32x4 v) {
+        vec out;
+        simd::store(&out.x, v);
+        return out;
+    }
+#endif
 };
 
 } // namespace rt
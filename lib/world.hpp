@@ -1,10 +1,29 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <mutex>
 #include <optional>
+#include <span>
+#include <stdexcept>
 #include <string_view>
+#include <utility>
 #include <vector>
+#include "aabb.hpp"
 #include "bitmap.hpp"
+#include "bvh.hpp"
+#include "camera.hpp"
 #include "ray.hpp"
+#include "ray_packet.hpp"
+#include "render_job.hpp"
+#include "sphere_store.hpp"
+#include "tile.hpp"
+#include "tiled_bitmap.hpp"
 
 namespace rt {
 
@@ -20,11 +39,15 @@ public:
         this->recalculateMatrix();
     }
 
-    [[nodiscard]] constexpr const mat<4, 4>& get_transform() const {
+    [[nodiscard]] constexpr const affine3x4& get_transform() const {
         return this->matrix;
     }
-    [[nodiscard]] constexpr mat<4, 4>& get_transform() {
-        return this->matrix;
+    [[nodiscard]] constexpr const affine3x4& get_inverse_transform() const {
+        return this->inverseMatrix;
+    }
+    // Transforms object space normals to world space, has no translation so only use it on vectors
+    [[nodiscard]] constexpr const affine3x4& get_inverse_transpose_transform() const {
+        return this->inverseTransposeMatrix;
     }
 
     constexpr void translate(vec translation) {
@@ -55,12 +78,32 @@ public:
         return this->scaleVec;
     }
 
+    // Object space bounds of whatever this transform is attached to
+    constexpr void set_local_bounds(const aabb& bounds) {
+        this->localBounds = bounds;
+        this->worldBounds = this->localBounds.transform(this->matrix);
+    }
+    [[nodiscard]] constexpr const aabb& get_local_bounds() const {
+        return this->localBounds;
+    }
+    // Local bounds in world space, only recomputed when the transform changes
+    [[nodiscard]] constexpr const aabb& get_world_bounds() const {
+        return this->worldBounds;
+    }
+
 private:
     constexpr void recalculateMatrix() {
-        this->matrix = mat<4, 4>::make_translation(this->translationVec) * mat<4, 4>::make_scaled(this->scaleVec);
+        this->matrix = affine3x4{mat<4, 4>::make_translation(this->translationVec) * mat<4, 4>::make_scaled(this->scaleVec)};
+        this->inverseMatrix = this->matrix.inverse();
+        this->inverseTransposeMatrix = this->inverseMatrix.transpose_linear();
+        this->worldBounds = this->localBounds.transform(this->matrix);
     }
 
-    mat<4,4> matrix;
+    affine3x4 matrix;
+    affine3x4 inverseMatrix;
+    affine3x4 inverseTransposeMatrix;
+    aabb localBounds;
+    aabb worldBounds;
     vec translationVec = vec::make_point(0, 0, 0);
     vec scaleVec = vec::make_vector(1, 1, 1);
 };
@@ -72,19 +115,15 @@ struct intersection {
 
     [[nodiscard]] constexpr bool operator==(const intersection& other) const = default;
 
-    [[nodiscard]] static std::optional<intersection> discard_occluded(const std::vector<intersection>& intersections) {
-        if (intersections.empty())
-            return {};
-        intersection best = intersections[0];
+    // Picks the closest intersection in front of the ray origin
+    [[nodiscard]] static std::optional<intersection> discard_occluded(std::span<const intersection> intersections) {
+        std::optional<intersection> best;
         for (const auto intersection : intersections) {
-            if ((best.distance < 0 && intersection.distance >= 0) || (intersection.distance <= best.distance)) {
+            if (intersection.distance >= 0 && (!best || intersection.distance <= best->distance)) {
                 best = intersection;
             }
         }
-        if (best.distance >= 0) {
-            return best;
-        }
-        return {};
+        return best;
     }
 };
 
@@ -103,15 +142,34 @@ struct object {
         return this->id == other.id;
     }
 
+    // Most intersections a single object can report for one ray
+    static constexpr std::size_t MAX_INTERSECTIONS = 2;
+
     [[nodiscard]] virtual constexpr bool intersects(ray r) const = 0;
-    [[nodiscard]] virtual std::vector<intersection> intersections(ray r) const = 0;
+    // True if anything is hit in [0, maxDistance), meant for occlusion tests that can stop at the first hit
+    [[nodiscard]] virtual bool intersects(ray r, float maxDistance) const = 0;
+    // Writes the intersections into out without allocating, returns how many were written
+    [[nodiscard]] virtual std::size_t intersections(ray r, std::span<intersection, MAX_INTERSECTIONS> out) const = 0;
+    [[nodiscard]] std::vector<intersection> intersections(ray r) const {
+        std::array<intersection, MAX_INTERSECTIONS> hits;
+        const auto count = this->intersections(r, hits);
+        return {hits.begin(), hits.begin() + static_cast<std::ptrdiff_t>(count)};
+    }
+    // Finds the closest intersection in [0, maxDistance), out is only written to if this returns true
+    [[nodiscard]] virtual bool closest_intersection(ray r, float maxDistance, intersection& out) const = 0;
+    // World space bounds of the transformed object, cached by the model transform
+    [[nodiscard]] virtual aabb bounds() const {
+        return this->model.get_world_bounds();
+    }
 };
 
 struct sphere : public object {
-    explicit constexpr sphere(std::size_t id_) : object(object_type::SPHERE, id_) {}
+    explicit constexpr sphere(std::size_t id_) : object(object_type::SPHERE, id_) {
+        this->model.set_local_bounds({vec::make_point(-1), vec::make_point(1)});
+    }
 
     [[nodiscard]] constexpr bool intersects(ray r) const override {
-        r *= this->model.get_transform().inverse();
+        r *= this->model.get_inverse_transform();
         auto sphereToRay = r.origin - vec::make_point(0,0,0);
         auto a = r.direction * r.direction;
         auto b = r.direction * sphereToRay * 2;
@@ -119,20 +177,55 @@ struct sphere : public object {
         auto d = b * b - (4 * a * c);
         return d >= 0;
     }
-    [[nodiscard]] std::vector<intersection> intersections(ray r) const override {
-        r *= this->model.get_transform().inverse();
-        auto sphereToRay = r.origin - vec::make_point(0,0,0);
-        auto a = r.direction * r.direction;
-        auto b = r.direction * sphereToRay * 2;
-        auto c = sphereToRay * sphereToRay - 1;
-        auto d = b * b - (4 * a * c);
-        std::vector<intersection> out;
-        if (d >= 0) {
-            out.push_back({r, (-b - std::sqrtf(d)) / (2 * a), this->id});
-            out.push_back({r, (-b + std::sqrtf(d)) / (2 * a), this->id});
+    // Any intersection in [0, maxDistance) counts, there is no need to find the closest one
+    [[nodiscard]] bool intersects(ray r, float maxDistance) const override {
+        float nearDistance, farDistance;
+        if (!this->get_roots(r, nearDistance, farDistance)) {
+            return false;
         }
-        return out;
+        const auto distance = nearDistance >= 0 ? nearDistance : farDistance;
+        return distance >= 0 && distance < maxDistance;
     }
+    using object::intersections;
+    [[nodiscard]] std::size_t intersections(ray r, std::span<intersection, MAX_INTERSECTIONS> out) const override {
+        float nearDistance, farDistance;
+        if (!this->get_roots(r, nearDistance, farDistance)) {
+            return 0;
+        }
+        out[0] = {r, nearDistance, this->id};
+        out[1] = {r, farDistance, this->id};
+        return 2;
+    }
+    [[nodiscard]] bool closest_intersection(ray r, float maxDistance, intersection& out) const override {
+        float nearDistance, farDistance;
+        if (!this->get_roots(r, nearDistance, farDistance) || nearDistance >= maxDistance) {
+            return false;
+        }
+        // The near hit is the visible one, unless the ray starts inside the sphere
+        const auto distance = nearDistance >= 0 ? nearDistance : farDistance;
+        if (distance < 0 || distance >= maxDistance) {
+            return false;
+        }
+        out = {r, distance, this->id};
+        return true;
+    }
+
+private:
+    // Moves r into object space and solves for where it enters and leaves the unit sphere
+    [[nodiscard]] bool get_roots(ray& r, float& nearDistance, float& farDistance) const {
+        r *= this->model.get_inverse_transform();
+        return unit_sphere_roots(r, nearDistance, farDistance);
+    }
+};
+
+struct render_options {
+    std::size_t tileSize = 32;
+    // 0 uses every hardware thread
+    unsigned int threadCount = 0;
+    // Side of the pixel squares the first progressive pass traces a single sample for, a power of two
+    std::size_t progressiveBlockSize = 16;
+    // Refreshes the bitmap's 8 bit copy as each tile finishes, for showing renders while they run
+    bool updateRgb8 = false;
 };
 
 class world {
@@ -151,49 +244,344 @@ public:
         s->model.set_translation(origin);
         s->model.set_scale(scale);
         this->objects.push_back(s);
+        this->hierarchyDirty = true;
         return this->objects.size() - 1;
     }
 
+    // Moves an object that is already in the world. Objects are only changed through here, so the hierarchy and the copy
+    // of sphere transforms it holds never go stale.
+    void set_transform(std::size_t index, const transform& model) {
+        this->objects.at(index)->model = model;
+        this->hierarchyDirty = true;
+    }
+
+    // Queries rebuild the hierarchy on their own after add() or set_transform(), this only does it ahead of the first one
+    void rebuild() {
+        std::scoped_lock lock{this->hierarchyMutex};
+        this->build_hierarchy();
+    }
+
+    // Appends to out, so one buffer can be reused for many rays
+    void get_intersections(ray r, std::vector<intersection>& out) const {
+        std::array<intersection, object::MAX_INTERSECTIONS> hits;
+        for (const auto object : this->objects) {
+            const auto count = object->intersections(r, hits);
+            out.insert(out.end(), hits.begin(), hits.begin() + static_cast<std::ptrdiff_t>(count));
+        }
+    }
     [[nodiscard]] std::vector<intersection> get_intersections(ray r) const {
         std::vector<intersection> out;
-        for (const auto object : this->objects) {
-            if (auto intersections = object->intersections(r); !intersections.empty()) {
-                out.insert(out.end(), intersections.begin(), intersections.end());
+        this->get_intersections(r, out);
+        return out;
+    }
+    // Only keeps the closest hit so far, which lets objects and hierarchy nodes reject anything behind it early
+    [[nodiscard]] std::optional<intersection> get_closest_intersection(ray r, float maxDistance = std::numeric_limits<float>::infinity()) const {
+        const auto& hierarchy_ = this->get_hierarchy();
+        const auto& indices = hierarchy_.get_primitive_indices();
+        intersection hit;
+        bool found = false;
+        // Sphere hits only keep their slot, the intersection is built once the closest one is known
+        bool foundSphere = false;
+        std::size_t sphereSlot = 0;
+        float sphereDistance = 0.f;
+        hierarchy_.traverse(r, maxDistance, [&](std::size_t first, std::size_t count, float& maxDistance_) {
+            for (std::size_t batch = first; batch < first + count; batch += sphere_store::LANES) {
+                const auto batchCount = std::min(sphere_store::LANES, first + count - batch);
+                if (this->spheres.closest_intersection(r, batch, batchCount, maxDistance_, sphereSlot)) {
+                    sphereDistance = maxDistance_;
+                    foundSphere = true;
+                    found = false;
+                }
             }
+            for (std::size_t i = first; i < first + count; i++) {
+                if (!this->spheres.is_enabled(i) && this->objects[indices[i]]->closest_intersection(r, maxDistance_, hit)) {
+                    maxDistance_ = hit.distance;
+                    found = true;
+                    foundSphere = false;
+                }
+            }
+        });
+        if (foundSphere) {
+            const auto object = this->objects[indices[sphereSlot]];
+            return intersection{r * object->model.get_inverse_transform(), sphereDistance, object->id};
+        }
+        if (found) {
+            return hit;
+        }
+        return {};
+    }
+    // Closest hit for every ray of the packet, lanes outside its mask or missing everything are left empty.
+    // Coherent rays share the hierarchy walk and spheres are tested against all of them at once.
+    void get_closest_intersections(const ray_packet& packet, std::span<std::optional<intersection>, ray_packet::SIZE> out, float maxDistance = std::numeric_limits<float>::infinity()) const {
+        const auto& hierarchy_ = this->get_hierarchy();
+        const auto& indices = hierarchy_.get_primitive_indices();
+        float maxDistances[ray_packet::SIZE];
+        std::size_t sphereSlots[ray_packet::SIZE];
+        std::uint32_t foundSphere = 0;
+        std::fill(std::begin(maxDistances), std::end(maxDistances), maxDistance);
+        std::fill(out.begin(), out.end(), std::nullopt);
+
+        hierarchy_.traverse(packet, maxDistances, [&](std::size_t first, std::size_t count, std::uint32_t mask, float (&maxDistances_)[ray_packet::SIZE]) {
+            foundSphere |= this->spheres.closest_intersections(packet, mask, first, count, maxDistances_, sphereSlots);
+            for (std::size_t i = first; i < first + count; i++) {
+                if (this->spheres.is_enabled(i)) {
+                    continue;
+                }
+                for (std::size_t lane = 0; lane < ray_packet::SIZE; lane++) {
+                    intersection hit;
+                    if (((mask >> lane) & 1u) && this->objects[indices[i]]->closest_intersection(packet.get(lane), maxDistances_[lane], hit)) {
+                        maxDistances_[lane] = hit.distance;
+                        out[lane] = hit;
+                        foundSphere &= ~(1u << lane);
+                    }
+                }
+            }
+        });
+        for (; foundSphere != 0; foundSphere &= foundSphere - 1) {
+            const auto lane = static_cast<std::size_t>(std::countr_zero(foundSphere));
+            const auto object = this->objects[indices[sphereSlots[lane]]];
+            out[lane] = intersection{packet.get(lane) * object->model.get_inverse_transform(), maxDistances[lane], object->id};
         }
-        return out;
     }
     [[nodiscard]] std::optional<intersection> get_visible_intersection(ray r) const {
-        return intersection::discard_occluded(this->get_intersections(r));
+        return this->get_closest_intersection(r);
+    }
+    // Stops at the first object hit closer than maxDistance, e.g. for shadow rays towards a light
+    [[nodiscard]] bool occluded(ray r, float maxDistance = std::numeric_limits<float>::infinity()) const {
+        const auto& hierarchy_ = this->get_hierarchy();
+        const auto& indices = hierarchy_.get_primitive_indices();
+        return hierarchy_.traverse_any(r, maxDistance, [&](std::size_t first, std::size_t count) {
+            for (std::size_t batch = first; batch < first + count; batch += sphere_store::LANES) {
+                if (this->spheres.intersects(r, batch, std::min(sphere_store::LANES, first + count - batch), maxDistance)) {
+                    return true;
+                }
+            }
+            for (std::size_t i = first; i < first + count; i++) {
+                if (!this->spheres.is_enabled(i) && this->objects[indices[i]]->intersects(r, maxDistance)) {
+                    return true;
+                }
+            }
+            return false;
+        });
     }
 
-    [[nodiscard]] object* get_object(std::size_t index) const {
+    [[nodiscard]] const object* get_object(std::size_t index) const {
         return this->objects.at(index);
     }
-    [[nodiscard]] const std::vector<object*>& get_objects() const {
+    [[nodiscard]] std::span<const object* const> get_objects() const {
         return this->objects;
     }
 
-    [[nodiscard]] bitmap render(short width, short height, vec camOrigin, vec camDirectionFwd, vec camDirectionUp, float camFov) const {
-        bitmap pixels{width, height};
+    [[nodiscard]] bitmap render(const camera& cam, render_options options = {}) const {
+        bitmap pixels{cam.get_width(), cam.get_height()};
+        if (options.updateRgb8) {
+            pixels.allocate_rgb8();
+        }
+
+        tile_scheduler scheduler{cam.get_width(), cam.get_height(), options.tileSize, options.threadCount};
+        scheduler.run([&](const tile& t) {
+            this->render_tile(cam, t, pixels.view(t.x, t.y, t.width, t.height));
+            if (options.updateRgb8) {
+                pixels.update_rgb8(t.x, t.y, t.width, t.height);
+            }
+        });
+        return pixels;
+    }
+    // Renders into a framebuffer of the camera's size, for images too large for memory, and throws std::invalid_argument
+    // for any other size. Tiles follow the framebuffer's own and are released as they finish, options.tileSize and
+    // updateRgb8 are ignored.
+    void render(const camera& cam, tiled_bitmap& target, render_options options = {}) const {
+        if (target.get_width() != cam.get_width() || target.get_height() != cam.get_height()) {
+            throw std::invalid_argument{"framebuffer size doesn't match the camera"};
+        }
+        tile_scheduler scheduler{cam.get_width(), cam.get_height(), target.get_tile_size(), options.threadCount};
+        scheduler.run([&](const tile& t) {
+            this->render_tile(cam, t, target.view(t));
+            target.release(t);
+        });
+    }
+    // Starts render() on the thread pool and returns right away. Stopping is checked between tiles, see render_job::cancel().
+    // The world must outlive the job and not be changed while it runs.
+    [[nodiscard]] render_job render_async(const camera& cam, render_options options = {}) const {
+        auto& pool = thread_pool::get_global();
+        tile_scheduler scheduler{cam.get_width(), cam.get_height(), options.tileSize, options.threadCount, pool};
+        auto state = std::make_shared<render_job::shared_state>(cam.get_width(), cam.get_height(), scheduler.get_tiles().size(), pool);
+        if (options.updateRgb8) {
+            state->pixels.allocate_rgb8();
+        }
+        // Nobody waits on the pool's future, so failures are handed to the job instead, which must finish either way
+        pool.submit([this, cam, options, scheduler = std::move(scheduler), state] {
+            try {
+                scheduler.run([&](const tile& t) {
+                    this->render_tile(cam, t, state->pixels.view(t.x, t.y, t.width, t.height));
+                    if (options.updateRgb8) {
+                        state->pixels.update_rgb8(t.x, t.y, t.width, t.height);
+                    }
+                    state->finishedTiles.fetch_add(1, std::memory_order_relaxed);
+                }, state->stop.get_token());
+            } catch (...) {
+                state->error = std::current_exception();
+            }
+            state->done.store(true, std::memory_order_release);
+        });
+        return render_job{std::move(state)};
+    }
+    [[nodiscard]] bitmap render(std::size_t width, std::size_t height, vec camOrigin, vec camDirectionFwd, vec camDirectionUp, float camFov, render_options options = {}) const {
+        return this->render(camera{camOrigin, camDirectionFwd, camDirectionUp, camFov, width, height}, options);
+    }
+
+    // Renders options.tileSize rows at a time and calls onRows(rows, y) for each band from the top, on the calling thread.
+    // The next band renders on the pool while onRows handles the current one, so rows can go straight to an encoder
+    // with only two bands in memory.
+    template<typename F>
+    void render_rows(const camera& cam, F&& onRows, render_options options = {}) const {
+        const auto bandHeight = std::max<std::size_t>(options.tileSize, 1);
+        auto& pool = thread_pool::get_global();
+        bitmap bands[2] {{cam.get_width(), bandHeight}, {cam.get_width(), bandHeight}};
+        const auto render_band = [&](std::size_t y, bitmap& pixels) {
+            tile_scheduler scheduler{cam.get_width(), std::min(bandHeight, cam.get_height() - y), options.tileSize, options.threadCount, pool};
+            scheduler.run([&](const tile& t) {
+                this->render_tile(cam, {t.x, y + t.y, t.width, t.height}, pixels.view(t.x, t.y, t.width, t.height));
+            });
+        };
 
-        // https://stackoverflow.com/questions/5944109/raytracer-computing-eye-rays
-        for (short y = 0; y < height; y++) {
-            for (short x = 0; x < width; x++) {
-                vec pointOnScreen = camDirectionFwd * ((static_cast<float>(height) / 2) / std::tanf(camFov / 2)) +
-                                    -camDirectionUp * (y - (height / 2)) +
-                                    camDirectionFwd.cross(camDirectionUp) * (x - (width / 2));
-                ray r{camOrigin, pointOnScreen.normalize()};
-                if (this->get_visible_intersection(r)) {
-                    pixels.set_pixel({1,0,0}, x, y);
+        if (cam.get_height() > 0) {
+            render_band(0, bands[0]);
+        }
+        for (std::size_t y = 0, band = 0; y < cam.get_height(); y += bandHeight, band++) {
+            const auto nextY = y + bandHeight;
+            std::future<void> next;
+            if (nextY < cam.get_height()) {
+                next = pool.submit([&, nextY, band] {
+                    render_band(nextY, bands[(band + 1) % 2]);
+                });
+            }
+            // The next band renders into this frame, so it has to be done before anything unwinds past it
+            struct band_guard {
+                thread_pool& pool;
+                std::future<void>& next;
+                ~band_guard() {
+                    if (this->next.valid()) {
+                        this->pool.wait_until([this] {
+                            return this->next.wait_for(std::chrono::seconds{0}) == std::future_status::ready;
+                        });
+                    }
                 }
+            } guard{pool, next};
+            onRows(std::as_const(bands[band % 2]).view(0, 0, cam.get_width(), std::min(bandHeight, cam.get_height() - y)), y);
+            if (next.valid()) {
+                pool.wait(next);
             }
         }
+    }
+
+    // Renders in passes, starting with one sample per progressiveBlockSize square and halving the squares until every pixel is traced.
+    // Each pass only traces the pixels the earlier ones skipped, so the whole image costs about as much as render().
+    // onUpdate(pixels, dirty) is called once per tile and pass from whichever thread finished it, but never concurrently.
+    // Requesting stop ends the render after the tiles that are already running, leaving the coarser passes in place.
+    template<typename F>
+    bitmap render_progressive(const camera& cam, F&& onUpdate, render_options options = {}, std::stop_token stop = {}) const {
+        bitmap pixels{cam.get_width(), cam.get_height()};
+        if (options.updateRgb8) {
+            pixels.allocate_rgb8();
+        }
+
+        // Tiles are a multiple of the largest square, so no square straddles two tiles
+        const auto largestBlock = std::bit_floor(std::max<std::size_t>(options.progressiveBlockSize, 1));
+        const auto tileSize = (std::max<std::size_t>(options.tileSize, 1) + largestBlock - 1) / largestBlock * largestBlock;
+        tile_scheduler scheduler{cam.get_width(), cam.get_height(), tileSize, options.threadCount};
+        std::mutex updateMutex;
+        for (std::size_t blockSize = largestBlock; blockSize > 0 && !stop.stop_requested(); blockSize /= 2) {
+            const auto previousBlockSize = blockSize * 2;
+            scheduler.run([&](const tile& t) {
+                const auto view = pixels.view(t.x, t.y, t.width, t.height);
+                for (std::size_t y = 0; y < t.height; y += blockSize) {
+                    if (blockSize < largestBlock && y % previousBlockSize == 0) {
+                        // Every other sample on this row was traced by the previous pass
+                        this->render_span(cam, t, view, y, blockSize, previousBlockSize, blockSize);
+                    } else {
+                        this->render_span(cam, t, view, y, 0, blockSize, blockSize);
+                    }
+                }
+                if (options.updateRgb8) {
+                    pixels.update_rgb8(t.x, t.y, t.width, t.height);
+                }
+                std::scoped_lock lock{updateMutex};
+                onUpdate(std::as_const(pixels), t);
+            }, stop);
+        }
         return pixels;
     }
 
 private:
+    // pixels holds the tile's pixels, wherever they are stored
+    void render_tile(const camera& cam, const tile& t, bitmap_view pixels) const {
+        for (std::size_t y = 0; y < t.height; y++) {
+            this->render_span(cam, t, pixels, y, 0, 1, 1);
+        }
+    }
+
+    // Traces the pixels first, first + stride, ... on row y of the tile, in packets of neighbouring samples.
+    // Coordinates are relative to the tile, each sample's color fills the blockSize square to its bottom right.
+    void render_span(const camera& cam, const tile& t, bitmap_view pixels, std::size_t y, std::size_t first, std::size_t stride, std::size_t blockSize) const {
+        const auto step = cam.get_column_step() * static_cast<float>(stride);
+        auto direction = cam.get_direction(static_cast<float>(t.x + first), static_cast<float>(t.y + y));
+        std::array<std::optional<intersection>, ray_packet::SIZE> hits;
+        for (std::size_t x = first; x < t.width; x += stride * ray_packet::SIZE) {
+            const auto lanes = std::min(ray_packet::SIZE, (t.width - x + stride - 1) / stride);
+            ray_packet packet;
+            for (std::size_t lane = 0; lane < lanes; lane++) {
+                packet.set(lane, {cam.get_origin(), direction.normalize()});
+                direction += step;
+            }
+            this->get_closest_intersections(packet, hits);
+            for (std::size_t lane = 0; lane < lanes; lane++) {
+                const color c = hits[lane] ? color{1, 0, 0} : color{0, 0, 0};
+                const auto sampleX = x + lane * stride;
+                const auto block = pixels.subview(sampleX, y, std::min(blockSize, pixels.get_width() - sampleX), std::min(blockSize, pixels.get_height() - y));
+                for (std::size_t by = 0; by < block.get_height(); by++) {
+                    std::ranges::fill(block.row(by), c);
+                }
+            }
+        }
+    }
+
+    void build_hierarchy() const {
+        std::vector<aabb> bounds;
+        bounds.reserve(this->objects.size());
+        for (const auto object : this->objects) {
+            bounds.push_back(object->bounds());
+        }
+        this->hierarchy.build(bounds);
+
+        // Spheres are laid out in leaf order, so every leaf is a contiguous run of slots
+        const auto& indices = this->hierarchy.get_primitive_indices();
+        this->spheres.resize(indices.size());
+        for (std::size_t i = 0; i < indices.size(); i++) {
+            const auto object = this->objects[indices[i]];
+            if (object->type == object_type::SPHERE) {
+                this->spheres.set(i, object->model.get_inverse_transform());
+            }
+        }
+        this->hierarchyDirty.store(false, std::memory_order_release);
+    }
+
+    // Render threads may all get here at once after add(), only the first one through the lock builds
+    [[nodiscard]] const bvh& get_hierarchy() const {
+        if (this->hierarchyDirty.load(std::memory_order_acquire)) {
+            std::scoped_lock lock{this->hierarchyMutex};
+            if (this->hierarchyDirty.load(std::memory_order_relaxed)) {
+                this->build_hierarchy();
+            }
+        }
+        return this->hierarchy;
+    }
+
     std::vector<object*> objects;
+    mutable bvh hierarchy;
+    mutable sphere_store spheres;
+    mutable std::mutex hierarchyMutex;
+    mutable std::atomic<bool> hierarchyDirty = false;
 };
 
 } // namespace rt
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <aabb.hpp>
+
+using namespace rt;
+
+TEST(aabb, expand_merge) {
+    aabb b;
+    EXPECT_TRUE(b.is_empty());
+    EXPECT_FLOAT_EQ(b.surface_area(), 0);
+
+    b.expand(vec::make_point(1, 2, 3));
+    EXPECT_FALSE(b.is_empty());
+    b.expand(vec::make_point(-1, 0, 5));
+    EXPECT_EQ(b, aabb(vec::make_point(-1, 0, 3), vec::make_point(1, 2, 5)));
+    EXPECT_EQ(b.centroid(), vec::make_point(0, 1, 4));
+    EXPECT_EQ(b.extent(), vec::make_vector(2, 2, 2));
+    EXPECT_FLOAT_EQ(b.surface_area(), 24);
+
+    aabb other{vec::make_point(0), vec::make_point(10)};
+    EXPECT_EQ(b.merge(other), aabb(vec::make_point(-1, 0, 0), vec::make_point(10, 10, 10)));
+    EXPECT_EQ(b.merge(aabb{}), b);
+}
+
+TEST(aabb, intersects) {
+    aabb b{vec::make_point(-1), vec::make_point(1)};
+
+    ray r1{vec::make_point(0, 0, -5), vec::make_vector(0, 0, 1)};
+    EXPECT_TRUE(b.intersects(r1));
+    EXPECT_TRUE(b.intersects(r1, 4.5f));
+    EXPECT_FALSE(b.intersects(r1, 3.5f));
+
+    // Behind
+    ray r2{vec::make_point(0, 0, 5), vec::make_vector(0, 0, 1)};
+    EXPECT_FALSE(b.intersects(r2));
+
+    // Inside
+    ray r3{vec::make_point(0, 0, 0), vec::make_vector(1, 1, 0)};
+    EXPECT_TRUE(b.intersects(r3));
+
+    // Parallel to a slab, outside of it
+    ray r4{vec::make_point(0, 2, -5), vec::make_vector(0, 0, 1)};
+    EXPECT_FALSE(b.intersects(r4));
+
+    // Diagonal miss
+    ray r5{vec::make_point(-5, 0, -5), vec::make_vector(1, 0, -1)};
+    EXPECT_FALSE(b.intersects(r5));
+}
+
+TEST(aabb, transform) {
+    aabb b{vec::make_point(-1), vec::make_point(1)};
+    EXPECT_EQ(b.transform(affine3x4{mat<4,4>::make_translation(1, 2, 3) * mat<4,4>::make_scaled(2)}), aabb(vec::make_point(-1, 0, 1), vec::make_point(3, 4, 5)));
+
+    // Rotating a cube by 45 degrees makes its bounds wider
+    auto rotated = b.transform(affine3x4{mat<4,4>::make_rotated_z(PI_4)});
+    EXPECT_FLOAT_EQ(rotated.max.x, std::sqrt(2.f));
+    EXPECT_FLOAT_EQ(rotated.max.y, std::sqrt(2.f));
+    EXPECT_FLOAT_EQ(rotated.max.z, 1);
+
+    EXPECT_TRUE(aabb{}.transform(affine3x4{}).is_empty());
+}
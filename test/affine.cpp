@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <affine.hpp>
+
+using namespace rt;
+
+TEST(affine3x4, mat_conversion) {
+    auto m = mat<4,4>::make_translation(1, 2, 3) * mat<4,4>::make_rotated_y(PI_4) * mat<4,4>::make_sheared(1, 0, 0, 1, 0, 0);
+    affine3x4 a{m};
+    EXPECT_EQ(a, m);
+    EXPECT_EQ(a.to_mat(), m);
+    EXPECT_EQ(affine3x4{}, (mat<4,4>::make_identity()));
+    EXPECT_EQ(affine3x4::make_identity(), (mat<4,4>::make_identity()));
+}
+
+TEST(affine3x4, vec_multiplication) {
+    affine3x4 a{
+        1, 2, 3, 4,
+        2, 4, 4, 2,
+        8, 6, 4, 1
+    };
+    EXPECT_EQ(a * vec::make_point(1, 2, 3), vec::make_point(18, 24, 33));
+    EXPECT_EQ(a * vec::make_vector(1, 2, 3), vec::make_vector(14, 22, 32));
+}
+
+TEST(affine3x4, affine_multiplication) {
+    auto m1 = mat<4,4>::make_translation(10, 5, 7);
+    auto m2 = mat<4,4>::make_scaled(5) * mat<4,4>::make_rotated_x(PI_2);
+    EXPECT_EQ(affine3x4{m1} * affine3x4{m2}, m1 * m2);
+    EXPECT_EQ(affine3x4{m2} * affine3x4{m1}, m2 * m1);
+}
+
+TEST(affine3x4, inverse) {
+    auto m = mat<4,4>::make_translation(1, -2, 3) * mat<4,4>::make_rotated_z(PI_4) * mat<4,4>::make_scaled(2, 3, 4);
+    affine3x4 a{m};
+    ASSERT_TRUE(a.invertible());
+    EXPECT_FLOAT_EQ(a.determinant(), m.determinant());
+    EXPECT_EQ(a.inverse(), m.inverse());
+    EXPECT_EQ(a * a.inverse(), affine3x4::make_identity());
+
+    affine3x4 singular{
+        1, 2, 3, 0,
+        2, 4, 6, 0,
+        0, 0, 1, 0
+    };
+    EXPECT_FALSE(singular.invertible());
+    EXPECT_EQ(singular.inverse(), affine3x4::make_identity());
+}
+
+TEST(affine3x4, transpose_linear) {
+    affine3x4 a{
+        1, 2, 3, 4,
+        5, 6, 7, 8,
+        9, 10, 11, 12
+    };
+    affine3x4 t{
+        1, 5, 9, 0,
+        2, 6, 10, 0,
+        3, 7, 11, 0
+    };
+    EXPECT_EQ(a.transpose_linear(), t);
+}
@@ -1,6 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <bitmap.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
 
 using namespace rt;
 
@@ -18,14 +27,103 @@ TEST(bitmap, set_get_pixel) {
     EXPECT_EQ(b(2, 2), color(1, 0, 1));
 }
 
-/*
+TEST(bitmap, rgb8) {
+    bitmap b{5, 3};
+    // 5 pixels are 15 bytes, padded to 16
+    EXPECT_EQ(b.get_rgb8_stride(), 16);
+    b.set_pixel({1, 0.5f, 0}, 1, 1);
+    b.set_pixel({2, -1, std::numeric_limits<float>::quiet_NaN()}, 4, 2);
+    b.set_pixel({1, 1, 1}, 0, 0);
+
+    // Nothing is allocated until the copy is first updated, and then only the rectangle is filled in
+    EXPECT_EQ(b.get_rgb8(), nullptr);
+    EXPECT_EQ(bitmap{b}.get_rgb8(), nullptr);
+    b.update_rgb8(1, 1, 4, 2);
+    const auto* row1 = b.get_rgb8() + b.get_rgb8_stride();
+    EXPECT_EQ(row1[3], 255);
+    EXPECT_EQ(row1[4], 127);
+    EXPECT_EQ(row1[5], 0);
+    const auto* row2 = b.get_rgb8() + b.get_rgb8_stride() * 2;
+    EXPECT_EQ(row2[12], 255);
+    EXPECT_EQ(row2[13], 0);
+    EXPECT_EQ(row2[14], 0);
+    EXPECT_EQ(b.get_rgb8()[0], 0);
+
+    b.update_rgb8();
+    EXPECT_EQ(b.get_rgb8()[0], 255);
+
+    // Copies take the 8 bit pixels along
+    bitmap copy = b;
+    EXPECT_EQ(copy.get_rgb8()[0], 255);
+    EXPECT_EQ(copy.get_rgb8()[copy.get_rgb8_stride() + 4], 127);
+}
+
+TEST(bitmap, move) {
+    bitmap b{70000, 2};
+    EXPECT_EQ(b.get_width(), 70000);
+    b.set_pixel({1, 0, 1}, 69999, 1);
+
+    bitmap moved = std::move(b);
+    EXPECT_EQ(moved.get_width(), 70000);
+    EXPECT_EQ(moved.get_pixel(69999, 1), color(1, 0, 1));
+    EXPECT_EQ(b.get_width(), 0); // NOLINT(bugprone-use-after-move)
+    EXPECT_EQ(b.get_height(), 0);
+
+    bitmap assigned{1, 1};
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.get_width(), 70000);
+    EXPECT_EQ(assigned.get_pixel(69999, 1), color(1, 0, 1));
+}
+
+TEST(bitmap, view) {
+    bitmap b{6, 5};
+    auto v = b.view(2, 1, 3, 2);
+    EXPECT_EQ(v.get_width(), 3);
+    EXPECT_EQ(v.get_height(), 2);
+    EXPECT_EQ(v.get_stride(), 6);
+
+    // Writes go straight to the bitmap
+    v.set_pixel({1, 0, 0}, 0, 0);
+    v(2, 1) = {0, 1, 0};
+    EXPECT_EQ(b.get_pixel(2, 1), color(1, 0, 0));
+    EXPECT_EQ(b.get_pixel(4, 2), color(0, 1, 0));
+    std::ranges::fill(v.row(1), color{0, 0, 1});
+    EXPECT_EQ(b.get_pixel(1, 2), color(0, 0, 0));
+    EXPECT_EQ(b.get_pixel(2, 2), color(0, 0, 1));
+    EXPECT_EQ(b.get_pixel(5, 2), color(0, 0, 0));
+
+    auto sub = v.subview(1, 1, 2, 1);
+    EXPECT_EQ(sub.get_pixel(1, 0), color(0, 0, 1));
+    EXPECT_EQ(&sub(0, 0), &b(3, 2));
+
+    const bitmap& constant = b;
+    const_bitmap_view whole = constant.view();
+    EXPECT_EQ(whole.get_width(), 6);
+    EXPECT_EQ(whole.get_pixel(2, 1), color(1, 0, 0));
+    const_bitmap_view converted = v;
+    EXPECT_EQ(converted.get_pixel(2, 1), color(0, 0, 1));
+}
+
 TEST(bitmap, save) {
     bitmap b{8, 8};
-    for (short i = 0; i < b.get_width(); i++) {
-        for (short j = 0; j < b.get_height(); j++) {
+    for (std::size_t i = 0; i < b.get_width(); i++) {
+        for (std::size_t j = 0; j < b.get_height(); j++) {
             b(i, j) = color{0, i > j ? 1.f : 0.5f, 1};
         }
     }
-    b.save("test.png");
+
+    // The in memory PNG is exactly the file, with nothing in front of the signature or after IEND
+    const auto png = b.get_raw_png();
+    constexpr unsigned char SIGNATURE[] {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    ASSERT_GT(png.size(), sizeof(SIGNATURE) + 12);
+    EXPECT_TRUE(std::equal(std::begin(SIGNATURE), std::end(SIGNATURE), png.begin()));
+    EXPECT_EQ(std::string(png.end() - 8, png.end() - 4), "IEND");
+
+    const auto path = (std::filesystem::temp_directory_path() / "raytracer_test_save.png").string();
+    ASSERT_TRUE(b.save(path));
+    std::ifstream file{path, std::ios::binary};
+    const std::vector<unsigned char> saved{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    file.close();
+    std::remove(path.c_str());
+    EXPECT_EQ(png, saved);
 }
-*/
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <bvh.hpp>
+
+using namespace rt;
+
+namespace {
+
+std::vector<aabb> make_grid(int size) {
+    std::vector<aabb> boxes;
+    for (int x = 0; x < size; x++) {
+        for (int y = 0; y < size; y++) {
+            for (int z = 0; z < size; z++) {
+                auto center = vec::make_point(static_cast<float>(x) * 3, static_cast<float>(y) * 3, static_cast<float>(z) * 3);
+                boxes.emplace_back(center - vec::make_vector(1), center + vec::make_vector(1));
+            }
+        }
+    }
+    return boxes;
+}
+
+} // namespace
+
+TEST(bvh, build) {
+    bvh empty{std::vector<aabb>{}};
+    EXPECT_TRUE(empty.empty());
+
+    auto boxes = make_grid(8);
+    bvh b{boxes};
+    ASSERT_FALSE(b.empty());
+
+    // Every primitive is referenced by exactly one leaf, and leaves stay small
+    auto indices = b.get_primitive_indices();
+    std::sort(indices.begin(), indices.end());
+    for (std::uint32_t i = 0; i < boxes.size(); i++) {
+        EXPECT_EQ(indices[i], i);
+    }
+    std::vector<int> referenced(boxes.size());
+    for (const auto& node : b.get_nodes()) {
+        if (node.is_leaf()) {
+            EXPECT_LE(node.count, bvh::MAX_LEAF_SIZE);
+            for (std::uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                referenced[b.get_primitive_indices()[i]]++;
+            }
+        }
+    }
+    for (int count : referenced) {
+        EXPECT_EQ(count, 1);
+    }
+
+    // Identical boxes can't be split by the heuristic, but still have to end up in small leaves
+    std::vector<aabb> stacked(100, aabb{vec::make_point(0), vec::make_point(1)});
+    bvh b2{stacked};
+    for (const auto& node : b2.get_nodes()) {
+        if (node.is_leaf()) {
+            EXPECT_LE(node.count, bvh::MAX_LEAF_SIZE);
+        }
+    }
+}
+
+TEST(bvh, traverse) {
+    auto boxes = make_grid(6);
+    bvh b{boxes};
+
+    for (int i = 0; i < 50; i++) {
+        ray r{vec::make_point(-5, static_cast<float>(i % 7) * 2.5f, static_cast<float>(i / 7) * 2.5f), vec::make_vector(1, 0.1f * static_cast<float>(i % 3), 0.05f)};
+        std::vector<std::uint32_t> expected;
+        for (std::uint32_t j = 0; j < boxes.size(); j++) {
+            if (boxes[j].intersects(r)) {
+                expected.push_back(j);
+            }
+        }
+        std::vector<std::uint32_t> visited;
+        b.traverse(r, std::numeric_limits<float>::infinity(), [&](std::size_t first, std::size_t count, float&) {
+            for (std::size_t j = first; j < first + count; j++) {
+                if (boxes[b.get_primitive_indices()[j]].intersects(r)) {
+                    visited.push_back(b.get_primitive_indices()[j]);
+                }
+            }
+        });
+        std::sort(visited.begin(), visited.end());
+        EXPECT_EQ(visited, expected);
+
+        EXPECT_EQ(b.traverse_any(r, std::numeric_limits<float>::infinity(), [&](std::size_t first, std::size_t count) {
+            for (std::size_t j = first; j < first + count; j++) {
+                if (boxes[b.get_primitive_indices()[j]].intersects(r)) {
+                    return true;
+                }
+            }
+            return false;
+        }), !expected.empty());
+    }
+}
+
+TEST(bvh, traverse_packet) {
+    auto boxes = make_grid(6);
+    bvh b{boxes};
+
+    // Seven lanes, so the last one has to stay untouched
+    ray_packet packet;
+    for (std::size_t lane = 0; lane < 7; lane++) {
+        packet.set(lane, {vec::make_point(-5, static_cast<float>(lane) * 2.5f, 4), vec::make_vector(1, 0.1f * static_cast<float>(lane % 3), 0.05f)});
+    }
+    std::vector<std::uint32_t> visited[ray_packet::SIZE];
+    float maxDistances[ray_packet::SIZE];
+    std::fill(std::begin(maxDistances), std::end(maxDistances), std::numeric_limits<float>::infinity());
+    b.traverse(packet, maxDistances, [&](std::size_t first, std::size_t count, std::uint32_t mask, float (&)[ray_packet::SIZE]) {
+        for (std::size_t lane = 0; lane < ray_packet::SIZE; lane++) {
+            for (std::size_t j = first; j < first + count; j++) {
+                if (((mask >> lane) & 1u) && boxes[b.get_primitive_indices()[j]].intersects(packet.get(lane))) {
+                    visited[lane].push_back(b.get_primitive_indices()[j]);
+                }
+            }
+        }
+    });
+    for (std::size_t lane = 0; lane < ray_packet::SIZE; lane++) {
+        std::vector<std::uint32_t> expected;
+        if (packet.is_active(lane)) {
+            b.traverse(packet.get(lane), std::numeric_limits<float>::infinity(), [&](std::size_t first, std::size_t count, float&) {
+                for (std::size_t j = first; j < first + count; j++) {
+                    if (boxes[b.get_primitive_indices()[j]].intersects(packet.get(lane))) {
+                        expected.push_back(b.get_primitive_indices()[j]);
+                    }
+                }
+            });
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(visited[lane].begin(), visited[lane].end());
+        EXPECT_EQ(visited[lane], expected);
+    }
+
+    // Lanes that found something closer cull the nodes behind it
+    std::fill(std::begin(maxDistances), std::end(maxDistances), 1.f);
+    bool visitedAny = false;
+    b.traverse(packet, maxDistances, [&](std::size_t, std::size_t, std::uint32_t, float (&)[ray_packet::SIZE]) {
+        visitedAny = true;
+    });
+    EXPECT_FALSE(visitedAny);
+}
+
+TEST(bvh, face_plane) {
+    // Rays parallel to a face and lying in its plane touch the box, whichever plane of the slab it is
+    const std::vector<aabb> boxes {{vec::make_point(0, 0, 0), vec::make_point(1, 1, 1)}};
+    bvh b{boxes};
+    const ray rays[] {
+        {vec::make_point(-1, 1, 0.5f), vec::make_vector(1, 0, 0)},
+        {vec::make_point(-1, 0, 0.5f), vec::make_vector(1, 0, 0)},
+        {vec::make_point(0.5f, -1, 0), vec::make_vector(0, 1, 0)},
+        {vec::make_point(0.5f, -1, 1), vec::make_vector(0, 1, 0)},
+        {vec::make_point(0, 0.5f, 2), vec::make_vector(0, 0, -1)},
+        {vec::make_point(1, 0.5f, 2), vec::make_vector(0, 0, -1)},
+        {vec::make_point(0, 0, 2), vec::make_vector(0, 0, -1)},
+        // Beside the box in the same plane, a miss for every test
+        {vec::make_point(-1, 2, 0.5f), vec::make_vector(1, 0, 0)},
+    };
+    ray_packet packet;
+    for (std::size_t lane = 0; lane < std::size(rays); lane++) {
+        packet.set(lane, rays[lane]);
+    }
+    float maxDistances[ray_packet::SIZE];
+    std::fill(std::begin(maxDistances), std::end(maxDistances), std::numeric_limits<float>::infinity());
+    std::uint32_t packetHits = 0;
+    b.traverse(packet, maxDistances, [&](std::size_t, std::size_t, std::uint32_t mask, float (&)[ray_packet::SIZE]) {
+        packetHits |= mask;
+    });
+
+    for (std::size_t lane = 0; lane < std::size(rays); lane++) {
+        bool hit = false;
+        b.traverse(rays[lane], std::numeric_limits<float>::infinity(), [&](std::size_t, std::size_t, float&) {
+            hit = true;
+        });
+        const bool expected = lane + 1 < std::size(rays);
+        EXPECT_EQ(hit, expected) << "lane " << lane;
+        EXPECT_EQ(((packetHits >> lane) & 1u) != 0, expected) << "lane " << lane;
+        EXPECT_EQ(boxes[0].intersects(rays[lane]), expected) << "lane " << lane;
+    }
+}
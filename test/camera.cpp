@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <camera.hpp>
+#include <math.hpp>
+
+using namespace rt;
+
+TEST(camera, ctor) {
+    camera c{vec::make_point(1, 2, 3), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), PI_2, 64, 48};
+    EXPECT_EQ(c.get_width(), 64);
+    EXPECT_EQ(c.get_height(), 48);
+    EXPECT_EQ(c.get_origin(), vec::make_point(1, 2, 3));
+    EXPECT_EQ(c.get_column_step(), vec::make_vector(0, 0, 1).cross(vec::make_vector(0, 1, 0)));
+    EXPECT_EQ(c.get_row_step(), vec::make_vector(0, -1, 0));
+    EXPECT_EQ(c.get_ray(0, 0).origin, vec::make_point(1, 2, 3));
+    EXPECT_FLOAT_EQ(c.get_ray(3, 7).direction.magnitude(), 1);
+}
+
+TEST(camera, centered) {
+    // Odd sizes used to be off by half a pixel, the middle pixel must look straight ahead now
+    for (std::size_t size : {5, 6, 47, 48}) {
+        camera c{vec::make_point(0), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), PI_2, size, size};
+        const float middle = static_cast<float>(size - 1) / 2;
+        const auto center = c.get_ray(middle, middle).direction;
+        EXPECT_NEAR(center.x, 0, 1e-5f);
+        EXPECT_NEAR(center.y, 0, 1e-5f);
+
+        // Opposite corners mirror each other
+        const auto topLeft = c.get_direction(0, 0);
+        const auto bottomRight = c.get_direction(static_cast<float>(size - 1), static_cast<float>(size - 1));
+        EXPECT_FLOAT_EQ(topLeft.x, -bottomRight.x);
+        EXPECT_FLOAT_EQ(topLeft.y, -bottomRight.y);
+        EXPECT_FLOAT_EQ(topLeft.z, bottomRight.z);
+    }
+}
+
+TEST(camera, fov) {
+    // A 90 degree field of view puts the top and bottom edges of the image at 45 degrees
+    camera c{vec::make_point(0), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), PI_2, 20, 10};
+    const auto top = c.get_direction(9.5f, -0.5f);
+    EXPECT_FLOAT_EQ(top.y, top.z);
+    const auto bottom = c.get_direction(9.5f, 9.5f);
+    EXPECT_FLOAT_EQ(bottom.y, -bottom.z);
+}
+
+TEST(camera, incremental) {
+    camera c{vec::make_point(0), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), 1.2f, 33, 21};
+    for (std::size_t y = 0; y < c.get_height(); y++) {
+        auto direction = c.get_direction(0, y);
+        for (std::size_t x = 0; x < c.get_width(); x++) {
+            const auto expected = c.get_direction(x, y);
+            EXPECT_NEAR(direction.x, expected.x, 1e-4f);
+            EXPECT_NEAR(direction.y, expected.y, 1e-4f);
+            EXPECT_NEAR(direction.z, expected.z, 1e-4f);
+            direction += c.get_column_step();
+        }
+    }
+
+    c.set_resolution(65, 41);
+    EXPECT_EQ(c.get_width(), 65);
+    EXPECT_NEAR(c.get_direction(32, 20).y, 0, 1e-5f);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <deflate.hpp>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "inflater.hpp"
+
+using namespace rt;
+using rt::test::inflater;
+
+namespace {
+
+std::vector<unsigned char> compress(std::span<const unsigned char> data, int level, std::size_t pieceSize) {
+    deflate_encoder encoder{level};
+    std::vector<unsigned char> out;
+    for (std::size_t i = 0; i < data.size(); i += pieceSize) {
+        encoder.write(data.subspan(i, std::min(pieceSize, data.size() - i)), out);
+    }
+    encoder.finish(out);
+    return out;
+}
+
+} // namespace
+
+TEST(deflate, adler32) {
+    constexpr std::string_view text = "Wikipedia";
+    EXPECT_EQ(adler32({reinterpret_cast<const unsigned char*>(text.data()), text.size()}), 0x11E60398u);
+    EXPECT_EQ(adler32({}), 1u);
+    // Checksums can be carried across pieces
+    const std::vector<unsigned char> zeros(100000, 7);
+    EXPECT_EQ(adler32(std::span{zeros}.subspan(40000), adler32(std::span{zeros}.first(40000))), adler32(zeros));
+    // or computed separately and combined
+    std::vector<unsigned char> counting(200000);
+    for (std::size_t i = 0; i < counting.size(); i++) {
+        counting[i] = static_cast<unsigned char>(i * 7);
+    }
+    const std::span all{counting};
+    for (const std::size_t split : {std::size_t{0}, std::size_t{1}, std::size_t{65521}, std::size_t{123456}}) {
+        EXPECT_EQ(adler32_combine(adler32(all.first(split)), adler32(all.subspan(split)), counting.size() - split), adler32(counting));
+    }
+}
+
+TEST(deflate, round_trip) {
+    std::mt19937 random{42};
+    const std::vector<unsigned char> zeros(1 << 19, 0);
+    std::vector<unsigned char> noise(100000);
+    for (auto& byte : noise) {
+        byte = static_cast<unsigned char>(random());
+    }
+    // Runs and repeats at every distance, spread over several blocks and slides of the input
+    std::vector<unsigned char> mixed;
+    while (mixed.size() < 400000) {
+        const auto length = random() % 300 + 1;
+        if (random() % 2 && mixed.size() > 40000) {
+            const auto distance = random() % 32768 + 1;
+            for (std::size_t i = 0; i < length; i++) {
+                mixed.push_back(mixed[mixed.size() - distance]);
+            }
+        } else {
+            for (std::size_t i = 0; i < length; i++) {
+                mixed.push_back(static_cast<unsigned char>(random() % 4));
+            }
+        }
+    }
+
+    for (const auto& input : {std::vector<unsigned char>{}, std::vector<unsigned char>{'a'}, zeros, noise, mixed}) {
+        for (const int level : {0, 1, 4, 6, 9}) {
+            for (const std::size_t pieceSize : {std::size_t{1000}, std::size_t{1} << 30}) {
+                const auto compressed = compress(input, level, pieceSize);
+                const auto decompressed = inflater{compressed}.run();
+                ASSERT_TRUE(decompressed.has_value()) << "level " << level;
+                EXPECT_EQ(*decompressed, input) << "level " << level;
+            }
+            // How the input is split up doesn't change the output
+            EXPECT_EQ(compress(input, level, 1000), compress(input, level, std::size_t{1} << 30)) << "level " << level;
+        }
+    }
+
+    // Repetitive input has to actually shrink, and higher levels shouldn't do worse
+    EXPECT_LT(compress(mixed, 1, 4096).size(), mixed.size() / 2);
+    EXPECT_LE(compress(mixed, 9, 4096).size(), compress(mixed, 1, 4096).size());
+    EXPECT_LT(compress(zeros, 6, 4096).size(), 2000);
+    // Noise falls back to stored blocks
+    EXPECT_LT(compress(noise, 6, 4096).size(), noise.size() + 100);
+}
+
+TEST(deflate, split) {
+    std::mt19937 random{7};
+    std::vector<unsigned char> text;
+    while (text.size() < 300000) {
+        const auto word = random() % 64;
+        for (std::size_t i = 0; i < word % 9 + 1; i++) {
+            text.push_back(static_cast<unsigned char>('a' + (word + i) % 26));
+        }
+        text.push_back(' ');
+    }
+
+    // Pieces compressed by separate encoders, each with the data before it as its dictionary, make up one stream
+    const std::span all{text};
+    for (const int level : {0, 1, 6}) {
+        std::vector<unsigned char> joined;
+        std::size_t alone = 0;
+        for (std::size_t start = 0; start < text.size(); start += 70000) {
+            const auto piece = all.subspan(start, std::min<std::size_t>(70000, text.size() - start));
+            deflate_encoder encoder{level};
+            encoder.set_dictionary(all.first(start));
+            encoder.write(piece, joined);
+            if (start + piece.size() == text.size()) {
+                encoder.finish(joined);
+            } else {
+                encoder.flush(joined);
+            }
+            alone += compress(piece, level, 1 << 30).size();
+        }
+        const auto decompressed = inflater{joined}.run();
+        ASSERT_TRUE(decompressed.has_value()) << "level " << level;
+        EXPECT_EQ(*decompressed, text) << "level " << level;
+        if (level > 0) {
+            // The dictionaries have to pay off against compressing the pieces on their own
+            EXPECT_LT(joined.size(), alone) << "level " << level;
+        }
+    }
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace rt::test {
+
+// Straightforward inflate to check deflate_encoder's output against, modelled after zlib's puff.c
+class inflater {
+public:
+    explicit inflater(std::span<const unsigned char> data_) : data(data_) {}
+
+    std::optional<std::vector<unsigned char>> run() {
+        std::vector<unsigned char> out;
+        bool last = false;
+        while (!last) {
+            last = this->bits(1);
+            const auto type = this->bits(2);
+            bool ok;
+            if (type == 0) {
+                ok = this->stored(out);
+            } else if (type == 1) {
+                std::vector<std::uint8_t> lengths(288 + 30);
+                for (std::size_t i = 0; i < 288; i++) {
+                    lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+                }
+                std::fill(lengths.begin() + 288, lengths.end(), 5);
+                ok = this->codes(out, huffman{{lengths.data(), 288}}, huffman{{lengths.data() + 288, 30}});
+            } else if (type == 2) {
+                ok = this->dynamic(out);
+            } else {
+                ok = false;
+            }
+            if (!ok || this->failed) {
+                return std::nullopt;
+            }
+        }
+        return out;
+    }
+
+private:
+    struct huffman {
+        explicit huffman(std::span<const std::uint8_t> lengths) : counts(16) {
+            for (const auto length : lengths) {
+                this->counts[length]++;
+            }
+            std::vector<int> offsets(16);
+            for (std::size_t i = 1; i < 15; i++) {
+                offsets[i + 1] = offsets[i] + this->counts[i];
+            }
+            this->symbols.resize(lengths.size());
+            for (std::size_t i = 0; i < lengths.size(); i++) {
+                if (lengths[i] != 0) {
+                    this->symbols[static_cast<std::size_t>(offsets[lengths[i]]++)] = static_cast<int>(i);
+                }
+            }
+        }
+        std::vector<int> counts;
+        std::vector<int> symbols;
+    };
+
+    std::uint32_t bits(unsigned int count) {
+        std::uint32_t value = 0;
+        for (unsigned int i = 0; i < count; i++) {
+            if (this->position / 8 >= this->data.size()) {
+                this->failed = true;
+                return 0;
+            }
+            value |= static_cast<std::uint32_t>((this->data[this->position / 8] >> (this->position % 8)) & 1) << i;
+            this->position++;
+        }
+        return value;
+    }
+
+    int decode(const huffman& h) {
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (std::size_t length = 1; length < 16; length++) {
+            code |= static_cast<int>(this->bits(1));
+            const int count = h.counts[length];
+            if (code - first < count) {
+                return h.symbols[static_cast<std::size_t>(index + code - first)];
+            }
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        this->failed = true;
+        return 0;
+    }
+
+    bool stored(std::vector<unsigned char>& out) {
+        this->position = (this->position + 7) / 8 * 8;
+        const auto length = this->bits(16);
+        if ((length ^ 0xFFFF) != this->bits(16)) {
+            return false;
+        }
+        for (std::uint32_t i = 0; i < length; i++) {
+            out.push_back(static_cast<unsigned char>(this->bits(8)));
+        }
+        return true;
+    }
+
+    bool codes(std::vector<unsigned char>& out, const huffman& literals, const huffman& distances) {
+        static constexpr int LENGTH_BASE[] {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static constexpr int LENGTH_EXTRA[] {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static constexpr int DISTANCE_BASE[] {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static constexpr int DISTANCE_EXTRA[] {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        while (!this->failed) {
+            const int symbol = this->decode(literals);
+            if (symbol < 256) {
+                out.push_back(static_cast<unsigned char>(symbol));
+            } else if (symbol == 256) {
+                return true;
+            } else {
+                const auto lengthCode = static_cast<std::size_t>(symbol - 257);
+                if (lengthCode >= 29) {
+                    return false;
+                }
+                const auto length = static_cast<std::size_t>(LENGTH_BASE[lengthCode]) + this->bits(static_cast<unsigned int>(LENGTH_EXTRA[lengthCode]));
+                const auto distanceCode = static_cast<std::size_t>(this->decode(distances));
+                if (distanceCode >= 30) {
+                    return false;
+                }
+                const auto distance = static_cast<std::size_t>(DISTANCE_BASE[distanceCode]) + this->bits(static_cast<unsigned int>(DISTANCE_EXTRA[distanceCode]));
+                if (distance > out.size()) {
+                    return false;
+                }
+                for (std::size_t i = 0; i < length; i++) {
+                    out.push_back(out[out.size() - distance]);
+                }
+            }
+        }
+        return false;
+    }
+
+    bool dynamic(std::vector<unsigned char>& out) {
+        static constexpr std::size_t ORDER[] {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        const auto literalCount = this->bits(5) + 257;
+        const auto distanceCount = this->bits(5) + 1;
+        const auto codeLengthCount = this->bits(4) + 4;
+        std::vector<std::uint8_t> codeLengthLengths(19);
+        for (std::size_t i = 0; i < codeLengthCount; i++) {
+            codeLengthLengths[ORDER[i]] = static_cast<std::uint8_t>(this->bits(3));
+        }
+        const huffman codeLengths{codeLengthLengths};
+        std::vector<std::uint8_t> lengths;
+        while (lengths.size() < literalCount + distanceCount && !this->failed) {
+            const int symbol = this->decode(codeLengths);
+            if (symbol < 16) {
+                lengths.push_back(static_cast<std::uint8_t>(symbol));
+            } else if (symbol == 16) {
+                if (lengths.empty()) {
+                    return false;
+                }
+                lengths.insert(lengths.end(), 3 + this->bits(2), lengths.back());
+            } else {
+                lengths.insert(lengths.end(), symbol == 17 ? 3 + this->bits(3) : 11 + this->bits(7), 0);
+            }
+        }
+        if (lengths.size() != literalCount + distanceCount) {
+            return false;
+        }
+        return this->codes(out, huffman{{lengths.data(), literalCount}}, huffman{{lengths.data() + literalCount, distanceCount}});
+    }
+
+    std::span<const unsigned char> data;
+    std::size_t position = 0;
+    bool failed = false;
+};
+
+} // namespace rt::test
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include <mapped_file.hpp>
+#include <string>
+#include <utility>
+
+using namespace rt;
+
+TEST(mapped_file, create) {
+    mapped_file f;
+    std::string error;
+    ASSERT_TRUE(f.create(1 << 20, error)) << error;
+    ASSERT_EQ(f.size(), 1 << 20);
+    EXPECT_EQ(f.data()[12345], 0);
+    f.data()[12345] = 42;
+    f.data()[(1 << 20) - 1] = 7;
+
+    // Released pages come back with what was written to them
+    f.release(0, f.size());
+    EXPECT_EQ(f.data()[12345], 42);
+    EXPECT_EQ(f.data()[(1 << 20) - 1], 7);
+
+    mapped_file moved = std::move(f);
+    EXPECT_EQ(moved.data()[12345], 42);
+    EXPECT_EQ(f.data(), nullptr); // NOLINT(bugprone-use-after-move)
+    moved.close();
+    EXPECT_EQ(moved.size(), 0);
+}
+
+TEST(mapped_file, errors) {
+    mapped_file f;
+    std::string error;
+    EXPECT_FALSE(f.create(4096, error, "/this/directory/does/not/exist"));
+    EXPECT_FALSE(error.empty());
+    EXPECT_EQ(f.data(), nullptr);
+
+    EXPECT_TRUE(f.create(0, error));
+    EXPECT_EQ(f.size(), 0);
+}
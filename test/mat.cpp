@@ -243,6 +243,45 @@ TEST(mat, inverse) {
     EXPECT_EQ(m7 * m6.inverse(), m5);
 }
 
+TEST(mat, inverse_4x4_paths) {
+    constexpr mat<4,4> m1{
+        8, -5, 9, 2,
+        7, 5, 6, 1,
+        -6, 0, 9, 6,
+        -3, 0, -9, -4
+    };
+    constexpr mat<4,4> m2{
+        9, 3, 0, 9,
+        -5, -2, -6, -3,
+        -4, 9, 6, 4,
+        -7, 6, 6, 2
+    };
+    auto m3 = mat<4,4>::make_translation(10, 5, 7) * mat<4,4>::make_scaled(5) * mat<4,4>::make_rotated_x(PI_2);
+    // determinant() only expands cofactors at compile time, at runtime it is the closed form
+    static_assert(m1.determinant() == -585);
+    static_assert(m2.determinant() == 1620);
+    EXPECT_FLOAT_EQ(m1.determinant_closed_form(), -585);
+    EXPECT_FLOAT_EQ(m2.determinant_closed_form(), 1620);
+    EXPECT_FLOAT_EQ(m3.determinant_closed_form(), 125);
+    for (const auto& m : {m1, m2, m3}) {
+        EXPECT_EQ(m.inverse_closed_form(), m.inverse_cofactors());
+        EXPECT_EQ(m.inverse_simd(), m.inverse_cofactors());
+        EXPECT_EQ(m * m.inverse(), (mat<4,4>::make_identity()));
+    }
+
+    mat<4,4> m4{
+        -4, 2, -2, -3,
+        9, 6, 2, 6,
+        0, -5, 1, -5,
+        0, 0, 0, 0
+    };
+    EXPECT_EQ(m4.inverse_closed_form(), (mat<4,4>::make_identity()));
+    EXPECT_EQ(m4.inverse_simd(), (mat<4,4>::make_identity()));
+
+    constexpr auto m5 = mat<4,4>::make_translation(1, 2, 3).inverse();
+    EXPECT_EQ(m5, (mat<4,4>::make_translation(-1, -2, -3)));
+}
+
 TEST(mat, set_get_values) {
     mat<2,2> m{
         1, 2,
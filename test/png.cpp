@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <png.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "inflater.hpp"
+
+using namespace rt;
+
+namespace {
+
+[[nodiscard]] std::uint32_t get_u32(const unsigned char* in) {
+    return static_cast<std::uint32_t>(in[0]) << 24 | static_cast<std::uint32_t>(in[1]) << 16 | static_cast<std::uint32_t>(in[2]) << 8 | in[3];
+}
+
+// Undoes a PNG row filter in place, previous is the already unfiltered row above
+void unfilter(unsigned char type, std::span<unsigned char> row, std::span<const unsigned char> previous) {
+    for (std::size_t i = 0; i < row.size(); i++) {
+        const int left = i >= 3 ? row[i - 3] : 0;
+        const int up = previous[i];
+        const int upLeft = i >= 3 ? previous[i - 3] : 0;
+        int prediction = 0;
+        if (type == 1) {
+            prediction = left;
+        } else if (type == 2) {
+            prediction = up;
+        } else if (type == 3) {
+            prediction = (left + up) / 2;
+        } else if (type == 4) {
+            const int estimate = left + up - upLeft;
+            const int a = std::abs(estimate - left);
+            const int b = std::abs(estimate - up);
+            const int c = std::abs(estimate - upLeft);
+            prediction = a <= b && a <= c ? left : b <= c ? up : upLeft;
+        }
+        row[i] = static_cast<unsigned char>(row[i] + prediction);
+    }
+}
+
+// Splits a PNG into its chunks, checking their CRCs and the image size, and returns the inflated filtered rows
+std::vector<unsigned char> read_png(std::span<const unsigned char> file, std::size_t width, std::size_t height) {
+    constexpr unsigned char SIGNATURE[] {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    EXPECT_TRUE(file.size() >= 8 && std::equal(std::begin(SIGNATURE), std::end(SIGNATURE), file.begin()));
+    std::vector<std::string> types;
+    std::vector<unsigned char> data;
+    for (std::size_t offset = 8; offset + 12 <= file.size();) {
+        const auto* chunk = file.data() + offset;
+        const auto length = get_u32(chunk);
+        types.emplace_back(chunk + 4, chunk + 8);
+        EXPECT_EQ(get_u32(chunk + 8 + length), crc32({chunk + 4, length + 4})) << types.back();
+        if (types.back() == "IHDR") {
+            EXPECT_EQ(get_u32(chunk + 8), width);
+            EXPECT_EQ(get_u32(chunk + 12), height);
+        } else if (types.back() == "IDAT") {
+            data.insert(data.end(), chunk + 8, chunk + 8 + length);
+        }
+        offset += 12 + length;
+    }
+    EXPECT_EQ(types.front(), "IHDR");
+    EXPECT_EQ(types.back(), "IEND");
+
+    // zlib header, deflate stream, Adler-32 of the filtered rows
+    if (data.size() <= 6) {
+        ADD_FAILURE() << "no image data";
+        return {};
+    }
+    EXPECT_EQ((data[0] * 256 + data[1]) % 31, 0);
+    auto filtered = rt::test::inflater{std::span{data}.subspan(2, data.size() - 6)}.run();
+    if (!filtered) {
+        ADD_FAILURE() << "invalid deflate stream";
+        return {};
+    }
+    EXPECT_EQ(get_u32(data.data() + data.size() - 4), adler32(*filtered));
+    return *filtered;
+}
+std::vector<unsigned char> read_png(const std::string& file, std::size_t width, std::size_t height) {
+    return read_png({reinterpret_cast<const unsigned char*>(file.data()), file.size()}, width, height);
+}
+
+// Unfilters the rows and compares them to the image
+void expect_pixels(std::vector<unsigned char> filtered, const_bitmap_view image) {
+    const std::size_t stride = image.get_width() * 3 + 1;
+    ASSERT_EQ(filtered.size(), stride * image.get_height());
+    std::vector<unsigned char> previous(image.get_width() * 3);
+    std::vector<unsigned char> expected(image.get_width() * 3);
+    for (std::size_t y = 0; y < image.get_height(); y++) {
+        const std::span row{filtered.data() + stride * y + 1, stride - 1};
+        ASSERT_LE(filtered[stride * y], 4);
+        unfilter(filtered[stride * y], row, previous);
+        to_rgb8(image.row(y), expected.data());
+        EXPECT_TRUE(std::equal(row.begin(), row.end(), expected.begin())) << "row " << y;
+        previous.assign(row.begin(), row.end());
+    }
+}
+
+[[nodiscard]] bitmap make_pattern(std::size_t width, std::size_t height) {
+    bitmap b{width, height};
+    for (std::size_t y = 0; y < height; y++) {
+        for (std::size_t x = 0; x < width; x++) {
+            b.set_pixel({static_cast<float>(x) / static_cast<float>(width), static_cast<float>(y % 7) / 7, (x * y) % 3 == 0 ? 1.f : 0.f}, x, y);
+        }
+    }
+    return b;
+}
+
+} // namespace
+
+TEST(png, crc32) {
+    const std::string text = "IEND";
+    EXPECT_EQ(crc32({reinterpret_cast<const unsigned char*>(text.data()), text.size()}), 0xAE426082u);
+}
+
+TEST(png, write_rows) {
+    const auto b = make_pattern(70, 40);
+
+    for (const int level : {0, 6}) {
+        std::ostringstream stream;
+        png_writer png{stream, b.get_width(), b.get_height(), level};
+        png.write_rows(b.view(0, 0, 70, 25));
+        png.write_rows(b.view(0, 25, 70, 15));
+        ASSERT_TRUE(png.finish());
+        expect_pixels(read_png(std::move(stream).str(), 70, 40), b.view());
+    }
+}
+
+TEST(png, write_png) {
+    // Tall enough for a few strips, which only decode if their dictionaries, flushes and checksums line up
+    const auto b = make_pattern(300, 700);
+    std::size_t storedSize = 0;
+    for (const int level : {0, 1, 6}) {
+        std::ostringstream one;
+        ASSERT_TRUE(write_png(one, b.view(), {.level = level, .threadCount = 1}));
+        const auto file = std::move(one).str();
+        expect_pixels(read_png(file, 300, 700), b.view());
+
+        // Strips always split at the same rows, so the thread count can't change the file
+        std::ostringstream many;
+        ASSERT_TRUE(write_png(many, b.view(), {.level = level, .threadCount = 4}));
+        EXPECT_EQ(file, many.str()) << "level " << level;
+        if (level == 0) {
+            storedSize = file.size();
+        } else {
+            EXPECT_LT(file.size(), storedSize / 4) << "level " << level;
+        }
+    }
+
+    // In memory it's the same file
+    const auto png = encode_png(b.view(), {.level = 1});
+    std::ostringstream stream;
+    ASSERT_TRUE(write_png(stream, b.view(), {.level = 1}));
+    EXPECT_EQ(std::string(png.begin(), png.end()), stream.str());
+    expect_pixels(read_png(png, 300, 700), b.view());
+}
+
+TEST(png, missing_rows) {
+    std::ostringstream stream;
+    png_writer png{stream, 4, 4};
+    const color row[4] {};
+    png.write_row(row);
+    EXPECT_FALSE(png.finish());
+}
@@ -43,3 +43,14 @@ TEST(ray, transform) {
     EXPECT_EQ(r4.origin, vec::make_point(2, 6, 12));
     EXPECT_EQ(r4.direction, vec::make_vector(0, 3, 0));
 }
+
+TEST(ray, transform_affine) {
+    ray r1{vec::make_point(1, 2, 3), vec::make_vector(0, 1, 0)};
+    auto m = mat<4,4>::make_translation(3, 4, 5) * mat<4,4>::make_scaled(2, 3, 4);
+    affine3x4 a{m};
+    EXPECT_EQ(r1.transform(a), r1.transform(m));
+    EXPECT_EQ(r1 * a, r1 * m);
+    r1 *= a;
+    EXPECT_EQ(r1.origin, vec::make_point(5, 10, 17));
+    EXPECT_EQ(r1.direction, vec::make_vector(0, 3, 0));
+}
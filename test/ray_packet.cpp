@@ -0,0 +1,24 @@
+#include <gtest/gtest.h>
+
+#include <ray_packet.hpp>
+
+using namespace rt;
+
+TEST(ray_packet, set_and_get) {
+    ray_packet packet;
+    EXPECT_EQ(packet.mask, 0);
+    EXPECT_FALSE(packet.is_active(0));
+
+    ray r1{vec::make_point(1, 2, 3), vec::make_vector(4, 5, 6)};
+    ray r2{vec::make_point(-1, 0, 1), vec::make_vector(0, 0, 1)};
+    packet.set(0, r1);
+    packet.set(5, r2);
+    EXPECT_EQ(packet.mask, 0b100001);
+    EXPECT_TRUE(packet.is_active(0));
+    EXPECT_FALSE(packet.is_active(1));
+    EXPECT_TRUE(packet.is_active(5));
+    EXPECT_EQ(packet.get(0), r1);
+    EXPECT_EQ(packet.get(5), r2);
+    EXPECT_FLOAT_EQ(packet.origin[1][0], 2);
+    EXPECT_FLOAT_EQ(packet.direction[2][5], 1);
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <scene.hpp>
+
+using namespace rt;
+
+TEST(scene, load) {
+    std::istringstream in{R"(
+# two spheres
+camera 0 1 -10  0 0 2  0 1 0  90
+sphere 0 0 0 1
+sphere 3 0 0  1 2 3   # stretched
+)"};
+    scene s;
+    std::string error;
+    ASSERT_TRUE(s.load(in, error)) << error;
+
+    const auto& objects = s.get_world().get_objects();
+    ASSERT_EQ(objects.size(), 2);
+    EXPECT_EQ(objects[0]->model.get_translation(), vec::make_point(0, 0, 0));
+    EXPECT_EQ(objects[1]->model.get_translation(), vec::make_point(3, 0, 0));
+    EXPECT_EQ(objects[1]->model.get_scale(), vec::make_vector(1, 2, 3));
+
+    const auto cam = s.make_camera(32, 16);
+    EXPECT_EQ(cam.get_width(), 32);
+    EXPECT_EQ(cam.get_height(), 16);
+    EXPECT_EQ(cam.get_origin(), vec::make_point(0, 1, -10));
+    EXPECT_EQ(cam.get_forward(), vec::make_vector(0, 0, 1));
+    EXPECT_FLOAT_EQ(cam.get_fov(), PI_2);
+}
+
+TEST(scene, load_errors) {
+    const std::pair<std::string_view, std::string_view> cases[] {
+        {"sphere 0 0 0 1\ncube 0 0 0", "line 2: unknown keyword 'cube'"},
+        {"sphere 0 0 0", "line 1: sphere needs a center and one or three scale values"},
+        {"sphere 0 0 0 1 2", "line 1: sphere needs a center and one or three scale values"},
+        {"camera 0 0 0 0 0 1", "line 1: camera needs an origin, forward and up vector and a field of view"},
+        {"\n\nsphere 0 0 0 1 2 3 x", "line 3: unexpected 'x' after sphere"},
+        {"sphere 0 0 0 1 x", "line 1: unexpected 'x' after sphere"},
+    };
+    for (const auto& [text, message] : cases) {
+        std::istringstream in{std::string{text}};
+        scene s;
+        std::string error;
+        EXPECT_FALSE(s.load(in, error));
+        EXPECT_EQ(error, message);
+        EXPECT_TRUE(s.get_world().get_objects().empty());
+    }
+
+    scene s;
+    std::string error;
+    EXPECT_FALSE(s.load("does/not/exist.scene", error));
+    EXPECT_EQ(error, "could not open does/not/exist.scene");
+}
+
+TEST(scene, make_default) {
+    scene s;
+    s.make_default();
+    EXPECT_FALSE(s.get_world().get_objects().empty());
+    EXPECT_TRUE(s.get_world().get_closest_intersection(s.make_camera(9, 9).get_ray(4, 4)));
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <sphere_store.hpp>
+#include <world.hpp>
+
+using namespace rt;
+
+namespace {
+
+// Ten spheres, so the second batch is only partially filled
+std::vector<sphere> make_spheres() {
+    std::vector<sphere> spheres;
+    for (std::size_t i = 0; i < 10; i++) {
+        auto& s = spheres.emplace_back(i);
+        s.model.set_translation(vec::make_point(static_cast<float>(i % 3) - 1, static_cast<float>(i % 2), static_cast<float>(i) * 2));
+        s.model.set_scale(vec::make_vector(0.5f + static_cast<float>(i % 4) * 0.25f, 1, 0.75f));
+    }
+    return spheres;
+}
+
+} // namespace
+
+TEST(sphere_store, resize) {
+    sphere_store store;
+    EXPECT_EQ(store.size(), 0);
+
+    store.resize(3);
+    EXPECT_EQ(store.size(), 3);
+    EXPECT_FALSE(store.is_enabled(1));
+    store.set(1, affine3x4{});
+    EXPECT_TRUE(store.is_enabled(1));
+    store.disable(1);
+    EXPECT_FALSE(store.is_enabled(1));
+}
+
+TEST(sphere_store, matches_sphere) {
+    const auto spheres = make_spheres();
+    sphere_store store;
+    store.resize(spheres.size());
+    for (std::size_t i = 0; i < spheres.size(); i++) {
+        store.set(i, spheres[i].model.get_inverse_transform());
+    }
+
+    const ray rays[] {
+        // Rays grazing a sphere may go either way depending on rounding, so these stay clear of the silhouettes
+        {vec::make_point(0, 0.1f, -5), vec::make_vector(0, 0, 1)},
+        {vec::make_point(-1, 1.1f, -5), vec::make_vector(0, 0, 1)},
+        {vec::make_point(0, 0.5f, 8), vec::make_vector(0, 0, -1)},
+        {vec::make_point(-1, 0, 0), vec::make_vector(0.1f, 0.2f, 1).normalize()},
+        {vec::make_point(5, 5, 5), vec::make_vector(1, 0, 0)},
+    };
+    for (const auto& r : rays) {
+        for (std::size_t first = 0; first < spheres.size(); first += sphere_store::LANES) {
+            const auto count = std::min(sphere_store::LANES, spheres.size() - first);
+            for (const float maxDistance : {std::numeric_limits<float>::infinity(), 6.f}) {
+                // Closest hit the spheres themselves report for this batch
+                float expected = maxDistance;
+                std::size_t expectedSlot = 0;
+                bool expectedFound = false;
+                intersection hit;
+                for (std::size_t i = first; i < first + count; i++) {
+                    if (spheres[i].closest_intersection(r, expected, hit)) {
+                        expected = hit.distance;
+                        expectedSlot = i;
+                        expectedFound = true;
+                    }
+                }
+
+                float distance = maxDistance;
+                std::size_t slot = 0;
+                ASSERT_EQ(store.closest_intersection(r, first, count, distance, slot), expectedFound);
+                EXPECT_EQ(store.intersects(r, first, count, maxDistance), expectedFound);
+                if (expectedFound) {
+                    EXPECT_EQ(slot, expectedSlot);
+                    EXPECT_NEAR(distance, expected, 1e-4f);
+                } else {
+                    EXPECT_EQ(distance, maxDistance);
+                }
+            }
+        }
+    }
+}
+
+TEST(sphere_store, disabled) {
+    sphere s{0};
+    sphere_store store;
+    store.resize(2);
+    store.set(0, s.model.get_inverse_transform());
+    store.set(1, s.model.get_inverse_transform());
+    store.disable(0);
+
+    const ray r{vec::make_point(0, 0, -5), vec::make_vector(0, 0, 1)};
+    float distance = std::numeric_limits<float>::infinity();
+    std::size_t slot = 0;
+    ASSERT_TRUE(store.closest_intersection(r, 0, 2, distance, slot));
+    EXPECT_EQ(slot, 1);
+    EXPECT_FLOAT_EQ(distance, 4);
+
+    // Slots past count are ignored even when they hold a sphere
+    EXPECT_FALSE(store.intersects(r, 0, 1, std::numeric_limits<float>::infinity()));
+    // Starting inside the sphere gives the far hit
+    const ray inside{vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1)};
+    distance = std::numeric_limits<float>::infinity();
+    ASSERT_TRUE(store.closest_intersection(inside, 0, 2, distance, slot));
+    EXPECT_FLOAT_EQ(distance, 1);
+}
+
+TEST(sphere_store, closest_intersections_packet) {
+    const auto spheres = make_spheres();
+    sphere_store store;
+    store.resize(spheres.size());
+    for (std::size_t i = 0; i < spheres.size(); i++) {
+        store.set(i, spheres[i].model.get_inverse_transform());
+    }
+    store.disable(3);
+
+    ray_packet packet;
+    for (std::size_t lane = 0; lane < ray_packet::SIZE; lane++) {
+        packet.set(lane, {vec::make_point(-1.2f + static_cast<float>(lane) * 0.3f, 0.1f, -5), vec::make_vector(0, 0.05f * static_cast<float>(lane), 1).normalize()});
+    }
+    // Lane 6 is left out and lane 7 already has something closer than every sphere
+    const std::uint32_t mask = packet.mask & ~(1u << 6);
+    float maxDistances[ray_packet::SIZE];
+    std::fill(std::begin(maxDistances), std::end(maxDistances), std::numeric_limits<float>::infinity());
+    maxDistances[7] = 0.5f;
+    std::size_t slots[ray_packet::SIZE] {};
+    const auto found = store.closest_intersections(packet, mask, 0, spheres.size(), maxDistances, slots);
+
+    for (std::size_t lane = 0; lane < ray_packet::SIZE; lane++) {
+        float expected = lane == 7 ? 0.5f : std::numeric_limits<float>::infinity();
+        std::size_t expectedSlot = 0;
+        bool expectedFound = false;
+        for (std::size_t first = 0; (mask >> lane) & 1u && first < spheres.size(); first += sphere_store::LANES) {
+            const auto count = std::min(sphere_store::LANES, spheres.size() - first);
+            expectedFound |= store.closest_intersection(packet.get(lane), first, count, expected, expectedSlot);
+        }
+        EXPECT_EQ(((found >> lane) & 1u) != 0, expectedFound);
+        if (expectedFound) {
+            EXPECT_EQ(slots[lane], expectedSlot);
+            EXPECT_NEAR(maxDistances[lane], expected, 1e-4f);
+        }
+    }
+    EXPECT_TRUE(found & 1u);
+    EXPECT_FALSE(found & (1u << 6));
+    EXPECT_FLOAT_EQ(maxDistances[7], 0.5f);
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <ctime>
+#include <thread_pool.hpp>
+
+using namespace rt;
+
+TEST(thread_pool, submit) {
+    thread_pool pool{2};
+    EXPECT_EQ(pool.get_thread_count(), 2);
+
+    auto f1 = pool.submit([] { return 5; });
+    auto f2 = pool.submit([] {});
+    EXPECT_EQ(pool.wait(f1), 5);
+    pool.wait(f2);
+
+    std::atomic<int> counter{0};
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 1000; i++) {
+        futures.push_back(pool.submit([&counter] { counter++; }));
+    }
+    for (auto& future : futures) {
+        pool.wait(future);
+    }
+    EXPECT_EQ(counter, 1000);
+}
+
+TEST(thread_pool, nested_wait) {
+    // Every worker blocks on subtasks it submitted itself, which only completes if waiting runs queued work
+    thread_pool pool{2};
+    std::vector<std::future<int>> outer;
+    for (int i = 0; i < 8; i++) {
+        outer.push_back(pool.submit([&pool, i] {
+            std::vector<std::future<int>> inner;
+            for (int j = 0; j < 8; j++) {
+                inner.push_back(pool.submit([i, j] { return i * j; }));
+            }
+            int sum = 0;
+            for (auto& future : inner) {
+                sum += pool.wait(future);
+            }
+            return sum;
+        }));
+    }
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(pool.wait(outer[i]), i * 28);
+    }
+}
+
+TEST(thread_pool, wait_sleeps) {
+    // Once the only task is running, waiting for it must not keep a core busy
+    thread_pool pool{1};
+    std::atomic<bool> started{false};
+    auto future = pool.submit([&started] {
+        started = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds{300});
+    });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    const auto cpuStart = std::clock();
+    pool.wait(future);
+    EXPECT_LT(static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC, 0.1);
+}
+
+TEST(thread_pool, get_global) {
+    EXPECT_EQ(&thread_pool::get_global(), &thread_pool::get_global());
+    EXPECT_GE(thread_pool::get_global().get_thread_count(), 1);
+}
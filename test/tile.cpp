@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <tile.hpp>
+
+using namespace rt;
+
+TEST(tile_scheduler, tiles) {
+    tile_scheduler s{10, 7, 4, 1};
+    const auto& tiles = s.get_tiles();
+    ASSERT_EQ(tiles.size(), 6);
+    EXPECT_EQ(tiles[0], (tile{0, 0, 4, 4}));
+    EXPECT_EQ(tiles[2], (tile{8, 0, 2, 4}));
+    EXPECT_EQ(tiles[3], (tile{0, 4, 4, 3}));
+    EXPECT_EQ(tiles[5], (tile{8, 4, 2, 3}));
+    EXPECT_EQ(s.get_thread_count(), 1);
+
+    tile_scheduler s2{10, 7};
+    EXPECT_GE(s2.get_thread_count(), 1);
+}
+
+TEST(tile_scheduler, run) {
+    tile_scheduler s{100, 50, 8, 4};
+    std::vector<int> hits(100 * 50);
+    std::mutex m;
+    std::size_t visited = 0;
+    s.run([&](const tile& t) {
+        for (std::size_t y = t.y; y < t.y + t.height; y++) {
+            for (std::size_t x = t.x; x < t.x + t.width; x++) {
+                hits[y * 100 + x]++;
+            }
+        }
+        std::scoped_lock lock{m};
+        visited++;
+    });
+    EXPECT_EQ(visited, s.get_tiles().size());
+    for (int hit : hits) {
+        EXPECT_EQ(hit, 1);
+    }
+}
+
+TEST(tile_scheduler, stop) {
+    tile_scheduler s{64, 64, 8, 1};
+    std::stop_source stop;
+    std::size_t count = 0;
+    s.run([&](const tile&) {
+        if (++count == 3) {
+            stop.request_stop();
+        }
+    }, stop.get_token());
+    EXPECT_EQ(count, 3);
+
+    // Stopped before it started, nothing runs
+    count = 0;
+    tile_scheduler parallel{64, 64, 8, 4};
+    parallel.run([&](const tile&) {
+        count++;
+    }, stop.get_token());
+    EXPECT_EQ(count, 0);
+}
+
+TEST(tile_scheduler, exception) {
+    // Thrown on the calling thread or a pool worker alike, run() waits for every worker and rethrows
+    for (const unsigned int threadCount : {1u, 4u}) {
+        tile_scheduler s{64, 64, 8, threadCount};
+        std::atomic<std::size_t> count{0};
+        EXPECT_THROW(s.run([&](const tile& t) {
+            count++;
+            if (t.x == 16 && t.y == 8) {
+                throw std::runtime_error{"tile failed"};
+            }
+        }), std::runtime_error);
+        if (threadCount == 1) {
+            // Tiles after the failed one don't start
+            EXPECT_EQ(count, 11);
+        }
+    }
+
+    // The scheduler keeps working afterwards
+    tile_scheduler s{16, 16, 8, 4};
+    std::atomic<std::size_t> count{0};
+    s.run([&](const tile&) {
+        count++;
+    });
+    EXPECT_EQ(count, 4);
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <tiled_bitmap.hpp>
+#include <vector>
+
+using namespace rt;
+
+TEST(tiled_bitmap, pixels) {
+    tiled_bitmap b;
+    std::string error;
+    ASSERT_TRUE(b.create(100, 70, error, 32)) << error;
+    EXPECT_EQ(b.get_width(), 100);
+    EXPECT_EQ(b.get_height(), 70);
+    EXPECT_EQ(b.get_tile_size(), 32);
+    EXPECT_EQ(b.get_pixel(99, 69), color(0, 0, 0));
+
+    for (std::size_t y = 0; y < b.get_height(); y++) {
+        for (std::size_t x = 0; x < b.get_width(); x++) {
+            b.set_pixel({static_cast<float>(x), static_cast<float>(y), 1}, x, y);
+        }
+    }
+    // Views of a tile index from its own corner
+    auto view = b.view({64, 32, 32, 32});
+    EXPECT_EQ(view.get_pixel(3, 5), color(67, 37, 1));
+    // Edge tiles are only as large as what is left of the image
+    auto corner = b.view({96, 64, 4, 6});
+    corner.set_pixel({0, 0, 0}, 3, 5);
+    EXPECT_EQ(b.get_pixel(99, 69), color(0, 0, 0));
+    b.set_pixel({99, 69, 1}, 99, 69);
+
+    b.release({0, 0, 100, 70});
+    std::vector<color> row(b.get_width());
+    b.read_row(40, row);
+    for (std::size_t x = 0; x < b.get_width(); x++) {
+        EXPECT_EQ(row[x], color(static_cast<float>(x), 40, 1));
+    }
+
+    std::size_t rows = 0;
+    b.read_rows([&](std::size_t y, std::span<const color> r) {
+        EXPECT_EQ(y, rows);
+        ASSERT_EQ(r.size(), b.get_width());
+        EXPECT_EQ(r[99], color(99, static_cast<float>(y), 1));
+        rows++;
+    });
+    EXPECT_EQ(rows, b.get_height());
+}
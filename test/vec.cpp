@@ -85,7 +85,7 @@ TEST(vec, is_unit_vector) {
     auto v7 = vec::make_vector(2, 0, 0);
     EXPECT_FALSE(v7.is_unit_vector());
 
-    auto v8 = vec::make_vector(1 / std::sqrtf(2), 1 / std::sqrtf(2), 0);
+    auto v8 = vec::make_vector(1 / std::sqrt(2.f), 1 / std::sqrt(2.f), 0);
     EXPECT_TRUE(v8.is_unit_vector());
 }
 
@@ -119,3 +119,16 @@ TEST(vec, scalar_operators) {
     EXPECT_EQ(v / 2, vec::make_vector(0.5f, 1.f, 1.5f));
     EXPECT_EQ(v / 0.5f, vec::make_vector(2, 4, 6));
 }
+
+TEST(vec, constexpr_evaluation) {
+    constexpr auto v1 = vec::make_vector(1, 2, 3);
+    constexpr auto v2 = vec::make_vector(2, 3, 4);
+    static_assert((v1 + v2).x == 3.f);
+    static_assert((v1 - v2).y == -1.f);
+    static_assert((v1 * 2).z == 6.f);
+    static_assert(v1.dot(v2) == 20.f);
+    static_assert(v1.cross(v2).x == -1.f);
+    EXPECT_EQ(v1 + v2, vec::make_vector(3, 5, 7));
+    EXPECT_FLOAT_EQ(v1.dot(v2), 20.f);
+    EXPECT_EQ(v1.cross(v2), vec::make_vector(-1, 2, -1));
+}
@@ -1,9 +1,47 @@
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 #include <world.hpp>
 
 using namespace rt;
 
+namespace {
+
+#ifdef RT_SIMD_AVX2
+// Relative difference allowed between sphere distances from the AVX2 kernel and from sphere itself. The kernel fuses
+// multiply-adds and solves for half of b, so it rounds differently. On a grazing ray the discriminant is close to zero
+// and the square root turns its rounding error into up to about sqrt(epsilon) of the distance.
+const float DISTANCE_TOLERANCE = std::sqrt(std::numeric_limits<float>::epsilon());
+#else
+// The scalar kernel shares sphere's math, so distances match exactly
+const float DISTANCE_TOLERANCE = 0;
+#endif
+
+// Object whose intersection code fails, which renders have to pass on rather than hang or lose
+struct failing_object : public object {
+    explicit failing_object(std::size_t id_) : object(static_cast<object_type>(-1), id_) {
+        this->model.set_local_bounds({vec::make_point(-1), vec::make_point(1)});
+    }
+
+    [[nodiscard]] bool intersects(ray) const override {
+        throw std::runtime_error{"intersection failed"};
+    }
+    [[nodiscard]] bool intersects(ray, float) const override {
+        throw std::runtime_error{"intersection failed"};
+    }
+    using object::intersections;
+    [[nodiscard]] std::size_t intersections(ray, std::span<intersection, MAX_INTERSECTIONS>) const override {
+        throw std::runtime_error{"intersection failed"};
+    }
+    [[nodiscard]] bool closest_intersection(ray, float, intersection&) const override {
+        throw std::runtime_error{"intersection failed"};
+    }
+};
+
+} // namespace
+
 TEST(transform, ctor) {
     transform t1{};
     EXPECT_EQ(t1.get_transform(), (mat<4,4>::make_identity()));
@@ -18,6 +56,37 @@ TEST(transform, ctor) {
     EXPECT_EQ(t4.get_transform(), (mat<4,4>::make_translation(2) * mat<4, 4>::make_scaled(2)));
 }
 
+TEST(transform, inverse) {
+    transform t{vec::make_point(1, 2, 3), vec::make_vector(2, 4, 8)};
+    EXPECT_EQ(t.get_inverse_transform(), t.get_transform().to_mat().inverse());
+    EXPECT_EQ(t.get_transform() * t.get_inverse_transform(), (mat<4,4>::make_identity()));
+
+    t.set_translation(vec::make_point(-4, 0, 1));
+    EXPECT_EQ(t.get_inverse_transform(), t.get_transform().to_mat().inverse());
+    t.set_scale(0.5f);
+    EXPECT_EQ(t.get_inverse_transform(), t.get_transform().to_mat().inverse());
+
+    auto n = vec::make_vector(1, 2, 3);
+    auto expected = t.get_transform().to_mat().inverse().transpose() * n;
+    expected.w = 0;
+    EXPECT_EQ(t.get_inverse_transpose_transform() * n, expected);
+}
+
+TEST(transform, bounds) {
+    transform t;
+    EXPECT_TRUE(t.get_world_bounds().is_empty());
+
+    t.set_local_bounds({vec::make_point(-1), vec::make_point(1)});
+    EXPECT_EQ(t.get_world_bounds(), aabb(vec::make_point(-1), vec::make_point(1)));
+
+    t.set_translation(vec::make_point(1, 2, 3));
+    EXPECT_EQ(t.get_world_bounds(), aabb(vec::make_point(0, 1, 2), vec::make_point(2, 3, 4)));
+
+    t.set_scale(vec::make_vector(1, 2, -3));
+    EXPECT_EQ(t.get_world_bounds(), aabb(vec::make_point(0, 0, 0), vec::make_point(2, 4, 6)));
+    EXPECT_EQ(t.get_local_bounds(), aabb(vec::make_point(-1), vec::make_point(1)));
+}
+
 TEST(intersection, discard_occluded) {
     std::vector<intersection> v;
     intersection i1{ray{}, 1, 0};
@@ -54,6 +123,15 @@ TEST(intersection, discard_occluded) {
     ASSERT_TRUE(ir4);
     EXPECT_EQ(ir4, i7);
     EXPECT_EQ(ir4, i8);
+
+    v.clear();
+    intersection i9{ray{}, 1, 0};
+    intersection i10{ray{}, -1, 0};
+    v.push_back(i9);
+    v.push_back(i10);
+    auto ir5 = intersection::discard_occluded(v);
+    ASSERT_TRUE(ir5);
+    EXPECT_EQ(*ir5, i9);
 }
 
 TEST(sphere, intersects_and_intersections) {
@@ -98,6 +176,63 @@ TEST(sphere, intersects_and_intersections) {
     EXPECT_FLOAT_EQ(i5[1].distance, -4);
 }
 
+TEST(sphere, intersections_buffer) {
+    sphere s{1};
+    std::array<intersection, object::MAX_INTERSECTIONS> hits;
+
+    ray r1{vec::make_point(0, 0, -5), vec::make_vector(0, 0, 1)};
+    ASSERT_EQ(s.intersections(r1, hits), 2);
+    EXPECT_FLOAT_EQ(hits[0].distance, 4);
+    EXPECT_FLOAT_EQ(hits[1].distance, 6);
+    EXPECT_EQ(hits[0].objectID, 1);
+
+    ray r2{vec::make_point(0, 2, -5), vec::make_vector(0, 0, 1)};
+    EXPECT_EQ(s.intersections(r2, hits), 0);
+}
+
+TEST(sphere, closest_intersection) {
+    sphere s{1};
+    s.model.set_scale(2);
+    intersection hit{};
+
+    ray r1{vec::make_point(0, 0, -5), vec::make_vector(0, 0, 1)};
+    ASSERT_TRUE(s.closest_intersection(r1, 100, hit));
+    EXPECT_FLOAT_EQ(hit.distance, 3);
+    EXPECT_EQ(hit.objectID, 1);
+    EXPECT_FALSE(s.closest_intersection(r1, 3, hit));
+
+    // Inside
+    ray r2{vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1)};
+    ASSERT_TRUE(s.closest_intersection(r2, 100, hit));
+    EXPECT_FLOAT_EQ(hit.distance, 2);
+
+    // Behind
+    ray r3{vec::make_point(0, 0, 5), vec::make_vector(0, 0, 1)};
+    EXPECT_FALSE(s.closest_intersection(r3, 100, hit));
+
+    // Miss
+    ray r4{vec::make_point(0, 3, -5), vec::make_vector(0, 0, 1)};
+    EXPECT_FALSE(s.closest_intersection(r4, 100, hit));
+}
+
+TEST(sphere, intersects_bounded) {
+    sphere s{1};
+    ray r1{vec::make_point(0, 0, -5), vec::make_vector(0, 0, 1)};
+    EXPECT_TRUE(s.intersects(r1, 100));
+    EXPECT_TRUE(s.intersects(r1, 4.5f));
+    EXPECT_FALSE(s.intersects(r1, 4));
+
+    // Inside
+    ray r2{vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1)};
+    EXPECT_TRUE(s.intersects(r2, 1.5f));
+    EXPECT_FALSE(s.intersects(r2, 0.5f));
+
+    // Behind
+    ray r3{vec::make_point(0, 0, 5), vec::make_vector(0, 0, 1)};
+    EXPECT_TRUE(s.intersects(r3));
+    EXPECT_FALSE(s.intersects(r3, 100));
+}
+
 TEST(sphere, intersects_and_intersections_transformed) {
     ray r{vec::make_point(0, 0, -5), vec::make_vector(0, 0, 1)};
 
@@ -143,6 +278,315 @@ TEST(world, add_sphere) {
     EXPECT_FLOAT_EQ(i4->distance, 0);
 }
 
+TEST(world, get_intersections_buffer) {
+    world w;
+    ray r{vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1)};
+    w.add<sphere>(vec::make_point(0, 0, 0), vec::make_vector(1));
+    w.add<sphere>(vec::make_point(0, 0, 2), vec::make_vector(2));
+
+    std::vector<intersection> buffer;
+    w.get_intersections(r, buffer);
+    EXPECT_EQ(buffer, w.get_intersections(r));
+    w.get_intersections(r, buffer);
+    EXPECT_EQ(buffer.size(), 8);
+
+    // The closest hit of the first sphere is behind the origin, the second sphere's isn't
+    ray r2{vec::make_point(0, 0, -0.5f), vec::make_vector(0, 0, 1)};
+    auto i = w.get_visible_intersection(r2);
+    ASSERT_TRUE(i);
+    EXPECT_FLOAT_EQ(i->distance, 0.5f);
+}
+
+TEST(world, render_parallel) {
+    world w;
+    w.add<sphere>(vec::make_point(0, -1, 4), vec::make_vector(1));
+    w.add<sphere>(vec::make_point(0, 2, 10), vec::make_vector(1));
+    auto serial = w.render(61, 47, vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), PI_2, {.tileSize = 64, .threadCount = 1});
+    auto parallel = w.render(61, 47, vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), PI_2, {.tileSize = 7, .threadCount = 4});
+    for (std::size_t y = 0; y < serial.get_height(); y++) {
+        for (std::size_t x = 0; x < serial.get_width(); x++) {
+            EXPECT_EQ(serial.get_pixel(x, y), parallel.get_pixel(x, y));
+        }
+    }
+}
+
+TEST(world, render_camera) {
+    world w;
+    w.add<sphere>(vec::make_point(0, 0, 4), vec::make_vector(1));
+    camera cam{vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), PI_2, 15, 15};
+    auto b = w.render(cam);
+    EXPECT_EQ(b.get_width(), 15);
+    EXPECT_EQ(b.get_height(), 15);
+
+    // The sphere is centered, so the image is symmetric even with an odd size
+    for (std::size_t y = 0; y < b.get_height(); y++) {
+        for (std::size_t x = 0; x < b.get_width(); x++) {
+            EXPECT_EQ(b.get_pixel(x, y), b.get_pixel(14 - x, 14 - y));
+            EXPECT_EQ(b.get_pixel(x, y) == color(1, 0, 0), w.get_closest_intersection(cam.get_ray(x, y)).has_value());
+        }
+    }
+    EXPECT_EQ(b.get_pixel(7, 7), color(1, 0, 0));
+    EXPECT_NE(b.get_pixel(0, 0), color(1, 0, 0));
+}
+
+TEST(world, render_tiled) {
+    world w;
+    w.add<sphere>(vec::make_point(0, -1, 4), vec::make_vector(1));
+    w.add<sphere>(vec::make_point(1, 2, 10), vec::make_vector(1));
+    camera cam{vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), PI_2, 61, 47};
+    const auto expected = w.render(cam);
+
+    tiled_bitmap target;
+    std::string error;
+    ASSERT_TRUE(target.create(61, 47, error, 16)) << error;
+    w.render(cam, target, {.threadCount = 3});
+    target.read_rows([&](std::size_t y, std::span<const color> row) {
+        for (std::size_t x = 0; x < row.size(); x++) {
+            EXPECT_EQ(row[x], expected.get_pixel(x, y));
+        }
+    });
+
+    // Rendering past the end of the mapping is refused
+    camera larger{vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), PI_2, 61, 48};
+    EXPECT_THROW(w.render(larger, target), std::invalid_argument);
+}
+
+TEST(world, render_rows) {
+    world w;
+    w.add<sphere>(vec::make_point(0, -1, 4), vec::make_vector(1));
+    w.add<sphere>(vec::make_point(1, 2, 10), vec::make_vector(1));
+    camera cam{vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), PI_2, 61, 47};
+    const auto expected = w.render(cam);
+
+    // Bands arrive in order, the last one cut short
+    std::size_t nextRow = 0;
+    w.render_rows(cam, [&](const_bitmap_view rows, std::size_t y) {
+        EXPECT_EQ(y, nextRow);
+        EXPECT_EQ(rows.get_width(), 61);
+        EXPECT_EQ(rows.get_height(), y == 40 ? 7 : 10);
+        for (std::size_t row = 0; row < rows.get_height(); row++) {
+            for (std::size_t x = 0; x < rows.get_width(); x++) {
+                EXPECT_EQ(rows.get_pixel(x, row), expected.get_pixel(x, y + row));
+            }
+        }
+        nextRow += rows.get_height();
+    }, {.tileSize = 10, .threadCount = 3});
+    EXPECT_EQ(nextRow, 47);
+
+    // Failures in onRows or in the bands come out of render_rows() once the band in flight is done
+    EXPECT_THROW(w.render_rows(cam, [](const_bitmap_view, std::size_t) {
+        throw std::runtime_error{"encoding failed"};
+    }, {.tileSize = 10, .threadCount = 3}), std::runtime_error);
+    w.add<failing_object>(vec::make_point(0, 0, 4), vec::make_vector(1));
+    EXPECT_THROW(w.render_rows(cam, [](const_bitmap_view, std::size_t) {}, {.tileSize = 10, .threadCount = 3}), std::runtime_error);
+}
+
+TEST(world, render_progressive) {
+    world w;
+    w.add<sphere>(vec::make_point(0, -1, 4), vec::make_vector(1));
+    w.add<sphere>(vec::make_point(1, 2, 10), vec::make_vector(1));
+    camera cam{vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), PI_2, 61, 47};
+    const auto expected = w.render(cam);
+
+    // 16, 8, 4, 2 and 1 pixel squares, over 64x64 tiles
+    std::vector<tile> updates;
+    bool previewMatches = true;
+    auto progressive = w.render_progressive(cam, [&](const bitmap& pixels, const tile& dirty) {
+        if (updates.empty()) {
+            // The first pass already has the final color in the corner of every square
+            for (std::size_t y = dirty.y; y < dirty.y + dirty.height; y += 16) {
+                for (std::size_t x = dirty.x; x < dirty.x + dirty.width; x += 16) {
+                    previewMatches = previewMatches && pixels.get_pixel(x, y) == expected.get_pixel(x, y);
+                }
+            }
+        }
+        updates.push_back(dirty);
+    }, {.tileSize = 50, .threadCount = 3});
+    EXPECT_TRUE(previewMatches);
+    ASSERT_EQ(updates.size(), 5);
+    for (const auto& dirty : updates) {
+        EXPECT_EQ(dirty, (tile{0, 0, 61, 47}));
+    }
+    for (std::size_t y = 0; y < expected.get_height(); y++) {
+        for (std::size_t x = 0; x < expected.get_width(); x++) {
+            EXPECT_EQ(progressive.get_pixel(x, y), expected.get_pixel(x, y));
+        }
+    }
+
+    // Small tiles still report every pixel once per pass
+    std::mutex mutex;
+    std::size_t area = 0;
+    auto smallTiles = w.render_progressive(cam, [&](const bitmap&, const tile& dirty) {
+        std::scoped_lock lock{mutex};
+        area += dirty.width * dirty.height;
+    }, {.tileSize = 8, .threadCount = 4, .progressiveBlockSize = 4});
+    EXPECT_EQ(area, 61 * 47 * 3);
+    EXPECT_EQ(smallTiles.get_pixel(30, 23), expected.get_pixel(30, 23));
+
+    // Stopping after the first update skips every later pass
+    std::stop_source stop;
+    std::size_t stoppedUpdates = 0;
+    (void) w.render_progressive(cam, [&](const bitmap&, const tile&) {
+        stoppedUpdates++;
+        stop.request_stop();
+    }, {.tileSize = 8, .threadCount = 1}, stop.get_token());
+    EXPECT_EQ(stoppedUpdates, 1);
+}
+
+TEST(world, render_async) {
+    world w;
+    w.add<sphere>(vec::make_point(0, -1, 4), vec::make_vector(1));
+    camera cam{vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), PI_2, 61, 47};
+    const auto expected = w.render(cam);
+
+    auto job = w.render_async(cam, {.tileSize = 8, .updateRgb8 = true});
+    const auto& pixels = job.wait();
+    EXPECT_TRUE(job.is_done());
+    EXPECT_FALSE(job.is_cancelled());
+    EXPECT_FLOAT_EQ(job.progress(), 1);
+    for (std::size_t y = 0; y < expected.get_height(); y++) {
+        for (std::size_t x = 0; x < expected.get_width(); x++) {
+            EXPECT_EQ(pixels.get_pixel(x, y), expected.get_pixel(x, y));
+            EXPECT_EQ(pixels.get_rgb8()[pixels.get_rgb8_stride() * y + x * 3], expected.get_pixel(x, y) == color(1, 0, 0) ? 255 : 0);
+        }
+    }
+
+    // Tiles that were already handed out may still finish, but wait() returns once they have
+    auto cancelled = w.render_async(camera{vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1), vec::make_vector(0, 1, 0), PI_2, 2000, 2000}, {.tileSize = 4});
+    cancelled.cancel();
+    (void) cancelled.wait();
+    EXPECT_TRUE(cancelled.is_done());
+    EXPECT_TRUE(cancelled.is_cancelled());
+    EXPECT_LT(cancelled.progress(), 1);
+
+    // A failing render still finishes, and wait() passes the error on
+    w.add<failing_object>(vec::make_point(0, 0, 4), vec::make_vector(1));
+    auto failed = w.render_async(cam, {.tileSize = 8});
+    EXPECT_THROW((void) failed.wait(), std::runtime_error);
+    EXPECT_TRUE(failed.is_done());
+    EXPECT_THROW((void) w.render(cam, {.tileSize = 8}), std::runtime_error);
+}
+
+TEST(world, get_closest_intersection) {
+    world w;
+    for (int i = 0; i < 5; i++) {
+        w.add<sphere>(vec::make_point(static_cast<float>(i) - 2, 0, static_cast<float>(i % 3) * 2), vec::make_vector(0.5f + static_cast<float>(i) * 0.25f));
+    }
+    for (int x = -10; x <= 10; x++) {
+        for (int y = -10; y <= 10; y++) {
+            ray r{vec::make_point(0, 0, -10), vec::make_vector(static_cast<float>(x) * 0.03f, static_cast<float>(y) * 0.03f, 1)};
+            auto expected = intersection::discard_occluded(w.get_intersections(r));
+            auto closest = w.get_closest_intersection(r);
+            ASSERT_EQ(expected.has_value(), closest.has_value());
+            if (expected) {
+                EXPECT_NEAR(expected->distance, closest->distance, expected->distance * DISTANCE_TOLERANCE);
+                EXPECT_EQ(expected->objectID, closest->objectID);
+            }
+        }
+    }
+
+    ray r{vec::make_point(-2, 0, -10), vec::make_vector(0, 0, 1)};
+    ASSERT_TRUE(w.get_closest_intersection(r));
+    EXPECT_FALSE(w.get_closest_intersection(r, w.get_closest_intersection(r)->distance));
+}
+
+TEST(world, get_closest_intersections_packet) {
+    world w;
+    for (int i = 0; i < 40; i++) {
+        w.add<sphere>(vec::make_point(static_cast<float>(i % 8) - 4, static_cast<float>(i / 8) - 2, static_cast<float>(i % 3) * 2), vec::make_vector(0.3f + static_cast<float>(i % 4) * 0.1f));
+    }
+    std::array<std::optional<intersection>, ray_packet::SIZE> hits;
+    for (int y = -10; y <= 10; y++) {
+        for (int x = -12; x <= 12; x += static_cast<int>(ray_packet::SIZE)) {
+            ray_packet packet;
+            for (std::size_t lane = 0; lane < ray_packet::SIZE && x + static_cast<int>(lane) <= 12; lane++) {
+                packet.set(lane, {vec::make_point(0, 0, -10), vec::make_vector(static_cast<float>(x + static_cast<int>(lane)) * 0.03f, static_cast<float>(y) * 0.03f, 1)});
+            }
+            w.get_closest_intersections(packet, hits);
+            for (std::size_t lane = 0; lane < ray_packet::SIZE; lane++) {
+                if (!packet.is_active(lane)) {
+                    EXPECT_FALSE(hits[lane]);
+                    continue;
+                }
+                const auto expected = w.get_closest_intersection(packet.get(lane));
+                ASSERT_EQ(expected.has_value(), hits[lane].has_value());
+                if (expected) {
+                    EXPECT_NEAR(expected->distance, hits[lane]->distance, expected->distance * DISTANCE_TOLERANCE);
+                    EXPECT_EQ(expected->objectID, hits[lane]->objectID);
+                    EXPECT_EQ(expected->rayHit, hits[lane]->rayHit);
+                }
+            }
+        }
+    }
+}
+
+TEST(world, occluded) {
+    world w;
+    w.add<sphere>(vec::make_point(0, 0, 5), vec::make_vector(1));
+    w.add<sphere>(vec::make_point(0, 0, 10), vec::make_vector(1));
+
+    ray r1{vec::make_point(0, 0, 0), vec::make_vector(0, 0, 1)};
+    EXPECT_TRUE(w.occluded(r1));
+    EXPECT_TRUE(w.occluded(r1, 5));
+    EXPECT_FALSE(w.occluded(r1, 4));
+
+    ray r2{vec::make_point(0, 0, 0), vec::make_vector(0, 0, -1)};
+    EXPECT_FALSE(w.occluded(r2));
+
+    ray r3{vec::make_point(0, 2, 0), vec::make_vector(0, 0, 1)};
+    EXPECT_FALSE(w.occluded(r3));
+}
+
+TEST(world, bounds) {
+    sphere s{0};
+    s.model.set_translation(vec::make_point(1, 2, 3));
+    s.model.set_scale(vec::make_vector(1, 2, 3));
+    EXPECT_EQ(s.bounds(), aabb(vec::make_point(0, 0, 0), vec::make_point(2, 4, 6)));
+
+    s.model.set_scale(1);
+    EXPECT_EQ(s.bounds(), aabb(vec::make_point(0, 1, 2), vec::make_point(2, 3, 4)));
+}
+
+TEST(world, hierarchy) {
+    // Compare against every intersection of every object, the hierarchy must not change the results
+    world w;
+    for (int i = 0; i < 400; i++) {
+        auto x = static_cast<float>(i % 20) - 10;
+        auto y = static_cast<float>(i / 20) - 10;
+        w.add<sphere>(vec::make_point(x, y, static_cast<float>((i * 7) % 13)), vec::make_vector(0.3f + static_cast<float>(i % 5) * 0.1f));
+    }
+    for (int x = -12; x <= 12; x++) {
+        for (int y = -12; y <= 12; y++) {
+            ray r{vec::make_point(0, 0, -20), vec::make_vector(static_cast<float>(x) * 0.02f, static_cast<float>(y) * 0.02f, 1)};
+            auto expected = intersection::discard_occluded(w.get_intersections(r));
+            auto closest = w.get_closest_intersection(r);
+            ASSERT_EQ(expected.has_value(), closest.has_value());
+            EXPECT_EQ(w.occluded(r), expected.has_value());
+            if (expected) {
+                // The reference goes through each sphere on its own, the hierarchy through the batched kernel
+                EXPECT_NEAR(expected->distance, closest->distance, expected->distance * DISTANCE_TOLERANCE);
+                EXPECT_FALSE(w.occluded(r, expected->distance * (1 - DISTANCE_TOLERANCE)));
+            }
+        }
+    }
+
+    // Moving an object rebuilds the hierarchy before the next query
+    ray r{vec::make_point(100, 100, -20), vec::make_vector(0, 0, 1)};
+    ray before{vec::make_point(-10, -10, -20), vec::make_vector(0, 0, 1)};
+    EXPECT_FALSE(w.get_closest_intersection(r));
+    ASSERT_TRUE(w.get_closest_intersection(before));
+    EXPECT_EQ(w.get_closest_intersection(before)->objectID, 0);
+    auto model = w.get_object(0)->model;
+    model.set_translation(vec::make_point(100, 100, 0));
+    w.set_transform(0, model);
+    ASSERT_TRUE(w.get_closest_intersection(r));
+    EXPECT_EQ(w.get_closest_intersection(r)->objectID, 0);
+    EXPECT_TRUE(w.occluded(r));
+    // and the sphere kernel's copy of its transform, which would still report it where it was
+    EXPECT_FALSE(w.get_closest_intersection(before));
+    EXPECT_FALSE(w.occluded(before));
+}
+
 /*
 TEST(world, render_spheres) {
     world w;